@@ -0,0 +1,80 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "sim/Archetype.h"
+#include "sim/Simulation.h"
+#include "sim/lib/components/Sprite.h"
+#include "sim/lib/components/Targets.h"
+#include "sim/lib/components/Transform.h"
+#include "sim/lib/systems/Movement.h"
+#include "sim/lib/systems/World.h"
+
+using namespace sim;
+using namespace sim::lib;
+
+struct Grass {};
+struct Sheep {};
+
+/// @brief Moves every movable entity towards a random neighbouring cell.
+struct Wander {
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<dim_t> dist{-5, 5};
+
+    void operator()(const event::PreCycle, ContextC auto ctx) {
+        ctx.template view<Transform, Target>().for_each([this](const Transform& t, Target& to) {
+            to.x = t.x + dist(rng);
+            to.y = t.y + dist(rng);
+        });
+    }
+};
+
+/// @brief Populates a simulation with a mix of static and moving entities and times a number of cycles.
+template<typename Sim>
+void benchmark(const char* name, const size_t count, const size_t cycles) {
+    using clock = std::chrono::steady_clock;
+
+    Sim s;
+    std::mt19937 rng{42};
+    std::uniform_int_distribution rand_coord{0, 1000};
+    std::uniform_int_distribution rand_speed{1, 3};
+
+    const auto setup_start = clock::now();
+    s.create_many(count)
+            .template emplace<Grass>()
+            .template generate<Transform>([&] {
+                const dim_t x = rand_coord(rng); // Drawn first, as the order of argument evaluation is unspecified
+                return Transform(x, rand_coord(rng));
+            })
+            .template emplace<Sprite>();
+    s.create_many(count)
+            .template emplace<Sheep>()
+            .template generate<Transform>([&] {
+                const dim_t x = rand_coord(rng); // Drawn first, as the order of argument evaluation is unspecified
+                return Transform(x, rand_coord(rng));
+            })
+            .template generate<Movable>([&] { return Movable(rand_speed(rng)); })
+            .template emplace<Target>()
+            .template emplace<Sprite>();
+    const auto setup_end = clock::now();
+
+    s.run(cycles);
+    const auto run_end = clock::now();
+
+    const auto ms = [](const auto duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    std::cout << name << ": setup " << ms(setup_end - setup_start) << " ms, "
+            << ms(run_end - setup_end) / static_cast<double>(cycles) << " ms per cycle" << std::endl;
+}
+
+int main() {
+    constexpr size_t count = 100000;
+    constexpr size_t cycles = 100;
+
+    benchmark<Simulation<Wander, Movement, WorldBoundary> >("Sparse sets", count, cycles);
+    benchmark<BasicSimulation<BasicRegistry<Grass, Sheep, Transform, Movable, Target, Sprite>,
+        Wander, Movement, WorldBoundary> >("Static sparse sets", count, cycles);
+    benchmark<ArchetypeSimulation<Wander, Movement, WorldBoundary> >("Archetypes", count, cycles);
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <iostream>
+#include <random>
+
+#include "sim/Simulation.h"
+#include "sim/lib/components/Sprite.h"
+#include "sim/lib/components/Transform.h"
+#include "sim/lib/systems/HeadlessRenderer.h"
+#include "sim/lib/systems/Movement.h"
+#include "sim/lib/systems/World.h"
+
+using namespace sim;
+using namespace sim::lib;
+
+// Runs without a window, writing every 10th frame to frames/frame_<cycle>.ppm
+int main() {
+    auto s = Simulation<>()
+            .with_systems<Movement, TargetResolver<RandomTarget>, WorldBoundary>()
+            .with_systems<HeadlessRenderer<10> >();
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<dim_t> position(0, 1000);
+    std::uniform_int_distribution<int> channel(0, 255);
+
+    for (int i = 0; i < 10000; ++i) {
+        const Color color{
+            static_cast<Color::color_t>(channel(rng)), static_cast<Color::color_t>(channel(rng)),
+            static_cast<Color::color_t>(channel(rng)), 255
+        };
+        s.create()
+                .emplace<Transform>(position(rng), position(rng)).emplace<Movable>(2)
+                .emplace<Target>().emplace<RandomTarget>()
+                .emplace<Sprite>(color, 4, 4);
+    }
+
+    s.run(100);
+
+    std::cout << "Done" << std::endl;
+    return 0;
+}
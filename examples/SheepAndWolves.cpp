@@ -6,6 +6,7 @@
 #include "sim/lib/systems/Interactor.h"
 #include "sim/lib/systems/Movement.h"
 #include "sim/lib/systems/Renderer.h"
+#include "sim/lib/systems/Spatial.h"
 #include "sim/lib/systems/World.h"
 
 using namespace sim;
@@ -29,6 +30,7 @@ int main() {
         Movement, WorldBoundary,
         TargetResolver<Sheep, Grass, Wolf>,
         TouchableTargets<Sheep, Grass>,
+        SpatialSort<60, Sprite, Movable, Target>,
         Renderer
     >();
 
@@ -47,11 +49,13 @@ int main() {
     std::uniform_int_distribution rand_speed{1, 3};
 
     // Grass
-    for (int i = 0; i < grass_count; ++i)
-        s.create()
-                .emplace<Grass>()
-                .emplace<Transform>(rand_coord(rng), rand_coord(rng))
-                .emplace<Sprite>(grass);
+    s.create_many(grass_count)
+            .emplace<Grass>()
+            .generate<Transform>([&] {
+                const dim_t x = rand_coord(rng);
+                return Transform{x, rand_coord(rng)};
+            })
+            .emplace<Sprite>(grass);
 
     // Sheep
     for (int i = 0; i < sheep_count; ++i)
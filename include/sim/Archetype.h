@@ -0,0 +1,1324 @@
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+#include <memory>
+#include <vector>
+
+#include "Registry.h"
+#include "ThreadPool.h"
+#include "View.h"
+
+namespace sim {
+    /// @brief Type-erased column of an archetype table, holding one component type.
+    class ArchetypeColumnBase {
+    public:
+        virtual ~ArchetypeColumnBase() = default;
+
+        /// @brief Create an empty column of the same component type.
+        /// @return The new column.
+        [[nodiscard]] virtual std::unique_ptr<ArchetypeColumnBase> make_empty() const = 0;
+
+        /// @brief Move a component from another column of the same type to the end of this one.
+        /// @param source The column to move from. The moved-from slot stays in place.
+        /// @param row The row of the component in the source column.
+        virtual void move_from(ArchetypeColumnBase& source, size_t row) = 0;
+
+        /// @brief Remove a row by swapping the last row into it.
+        /// @param row The row to remove.
+        virtual void swap_remove(size_t row) = 0;
+
+        /// @brief Reserve space for a number of rows.
+        /// @param n The number of rows.
+        virtual void reserve(size_t n) = 0;
+
+        /// @brief Reorder the rows.
+        /// @param order For each new row, the old row of the component to move there.
+        virtual void permute(std::span<const size_t> order) = 0;
+    };
+
+    /// @brief Column of an archetype table, storing its components in the pool selected by storage_policy.
+    /// @details Rows move whenever an entity changes its archetype, so a StablePool is replaced by a DensePool.
+    /// @tparam T The component type.
+    template<typename T>
+    class ArchetypeColumn final : public ArchetypeColumnBase {
+    public:
+        /// @brief The type of the pool holding the components.
+        using pool_type = std::conditional_t<is_stable_v<T>, DensePool<T>, pool_t<T> >;
+
+    private:
+        pool_type pool_;
+
+    public:
+        /// @brief Get the pool holding the components.
+        /// @return A reference to the pool.
+        [[nodiscard]] auto&& pool(this auto&& self);
+
+        [[nodiscard]] std::unique_ptr<ArchetypeColumnBase> make_empty() const override;
+
+        void move_from(ArchetypeColumnBase& source, size_t row) override;
+
+        void swap_remove(size_t row) override;
+
+        void reserve(size_t n) override;
+
+        void permute(std::span<const size_t> order) override;
+    };
+
+    /// @brief A table of all entities sharing exactly the same set of components.
+    /// @details Each component type has its own column, and all columns share the row order,
+    /// so the components of one entity are at the same row in every column.
+    /// Removed rows are left as tombstones until compaction.
+    class Archetype {
+        static constexpr uint32_t NO_COLUMN = std::numeric_limits<uint32_t>::max();
+
+        Signature signature_;
+        std::vector<id_t> entities_; // Entity of each row, NO_ID for tombstones
+        std::vector<std::unique_ptr<ArchetypeColumnBase> > columns_;
+        std::vector<component_id_t> column_components_; // Component ID of each column
+        std::vector<uint32_t> column_of_; // Column index for each component ID
+        std::vector<std::pair<component_id_t, Archetype*> > add_edges_; // Archetypes with one more component
+        std::vector<std::pair<component_id_t, Archetype*> > remove_edges_; // Archetypes with one less component
+        std::vector<size_t> holes_; // Rows of tombstones, may contain already compacted ones
+        size_t tombstones_ = 0;
+
+    public:
+        /// @brief Constructs an archetype without columns.
+        /// @param signature The set of components of the archetype.
+        explicit Archetype(const Signature& signature);
+
+        /// @brief Adds a column for a component. Only valid while the archetype is empty.
+        /// @param component_id The ID of the component.
+        /// @param column The column.
+        void add_column(component_id_t component_id, std::unique_ptr<ArchetypeColumnBase> column);
+
+        /// @brief Get the set of components of the archetype.
+        /// @return The signature of the archetype.
+        [[nodiscard]] const Signature& signature() const;
+
+        /// @brief Get the number of rows, including tombstones.
+        /// @return The number of rows.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Get the number of tombstone rows.
+        /// @return The number of tombstones.
+        [[nodiscard]] size_t tombstones() const;
+
+        /// @brief Get the entity of each row, NO_ID for tombstones.
+        /// @return The entities of the rows.
+        [[nodiscard]] const std::vector<id_t>& entities() const;
+
+        /// @brief Get the pool of a component column.
+        /// @tparam C The component type, which must be part of the archetype. Const qualified, the pool is read-only.
+        /// @return A reference to the pool.
+        template<typename C>
+        [[nodiscard]] auto&& pool(this auto&& self);
+
+        /// @brief Find a cached archetype with one more component.
+        /// @param component_id The added component.
+        /// @return The archetype, or nullptr if not cached.
+        [[nodiscard]] Archetype* add_edge(component_id_t component_id) const;
+
+        /// @brief Caches an archetype with one more component.
+        /// @param component_id The added component.
+        /// @param archetype The archetype with the component added.
+        void set_add_edge(component_id_t component_id, Archetype* archetype);
+
+        /// @brief Find a cached archetype with one less component.
+        /// @param component_id The removed component.
+        /// @return The archetype, or nullptr if not cached.
+        [[nodiscard]] Archetype* remove_edge(component_id_t component_id) const;
+
+        /// @brief Caches an archetype with one less component.
+        /// @param component_id The removed component.
+        /// @param archetype The archetype with the component removed.
+        void set_remove_edge(component_id_t component_id, Archetype* archetype);
+
+        /// @brief Creates an empty archetype with the same columns plus one for a new component.
+        /// @tparam C The new component type.
+        /// @return The new archetype.
+        template<typename C>
+        [[nodiscard]] std::unique_ptr<Archetype> extended() const;
+
+        /// @brief Creates an empty archetype with the same columns except the one of a component.
+        /// @param component_id The removed component, which must be part of the archetype.
+        /// @return The new archetype.
+        [[nodiscard]] std::unique_ptr<Archetype> reduced(component_id_t component_id) const;
+
+        /// @brief Appends a row for an entity without moving any components.
+        /// @param entity_id The entity of the row.
+        /// @return The new row.
+        size_t append(id_t entity_id);
+
+        /// @brief Appends a row for an entity, moving its components from a row of another archetype.
+        /// @details Columns of this archetype missing in the source are left for the caller to fill.
+        /// @param source The archetype to move from.
+        /// @param row The row in the source archetype. It is not removed from the source.
+        /// @param entity_id The entity of the row.
+        /// @return The new row.
+        size_t append_from(Archetype& source, size_t row, id_t entity_id);
+
+        /// @brief Marks a row as removed.
+        /// @param row The row.
+        void tombstone(size_t row);
+
+        /// @brief Removes at most a given number of tombstones by swapping the last row into them.
+        /// @param budget The maximum number of tombstones to remove.
+        /// @param moved Called with the entity ID and the new row of every row that got moved.
+        /// @return The number of tombstones removed.
+        size_t compact(size_t budget, auto&& moved);
+
+        /// @brief Reserve space for a number of additional rows.
+        /// @param n The number of additional rows.
+        void reserve(size_t n);
+
+        /// @brief Sorts the rows by a key computed from one component, compacting the archetype first.
+        /// @tparam C The component type the key is computed from, which must be part of the archetype.
+        /// @param key Called with each component of type C, returns a totally ordered key.
+        /// @param moved Called with the entity ID and the new row of every row.
+        template<typename C>
+        void sort_by(auto&& key, auto&& moved);
+    };
+
+    template<bool Imm, typename Optional, typename... Cs>
+    class ArchetypeView;
+
+    /// @brief A registry storing entities in archetype tables instead of one sparse set per component type.
+    /// @details Components of entities with the same set of components live in the same table, row by row,
+    /// so views iterate contiguous co-located components without membership checks.
+    /// Adding a component moves an entity to another table, which makes structural changes slower
+    /// and means components are never pointer-stable, regardless of their storage_policy.
+    /// Rows keep no change ticks, so added and changed view filters are rejected at compile time
+    /// (see has_change_ticks_v), while removals of tracked components are recorded as with Registry (see track_changes).
+    /// Provides the same interface as Registry and can be selected per simulation,
+    /// see BasicSimulation::with_backend() and ArchetypeSimulation.
+    class ArchetypeRegistry {
+        struct Location {
+            Archetype* archetype;
+            size_t row;
+        };
+
+        std::vector<std::unique_ptr<Archetype> > archetypes_; // The first one is the empty archetype
+        std::vector<Location> locations_; // Location of each entity, indexed by entity index
+        IdAllocator ids_;
+        size_t compaction_cursor_ = 0; // Archetype to continue incremental compaction from
+        tick_t tick_ = 0;
+        Signature tracked_; // Tracked component types added so far
+        std::vector<std::vector<std::pair<id_t, tick_t> > > removed_; // Removed entities and the tick, by component ID
+
+    public:
+        /// @brief The mutable entity handle type of this registry.
+        using entity_type = EntityBase<false, ArchetypeRegistry>;
+
+        /// @brief The immutable entity handle type of this registry.
+        using const_entity_type = EntityBase<true, ArchetypeRegistry>;
+
+        /// @brief Gets the ID of a component type, its bit in the signatures of archetypes.
+        /// @details See get_component_id(), archetypes accept any component type.
+        /// @tparam C The component type.
+        /// @return The ID of the component type.
+        /// @throws std::length_error if there are too many component types.
+        template<typename C>
+        [[nodiscard]] static component_id_t component_id();
+
+        /// @brief Default constructor.
+        explicit ArchetypeRegistry();
+
+        /// @brief Creates a new entity, recycling the index of a removed one if possible.
+        /// @throws std::length_error if the entity index space is exhausted.
+        /// @return A handle to the new entity.
+        entity_type create();
+
+        /// @brief Creates a number of entities at once, recycling indices of removed ones first.
+        /// @throws std::length_error if the entity index space would be exhausted.
+        /// @param n The number of entities to create.
+        /// @return A batch handle to the new entities.
+        BasicEntityBatch<ArchetypeRegistry> create_many(size_t n);
+
+        /// @brief Checks if an entity is alive, i.e. created and not yet removed.
+        /// @param entity_id The ID of the entity to check.
+        /// @return Whether the entity is alive.
+        [[nodiscard]] bool alive(id_t entity_id) const;
+
+        /// @brief Gets the number of alive entities.
+        /// @return The number of alive entities.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Gets the number of archetypes created so far.
+        /// @return The number of archetypes.
+        [[nodiscard]] size_t archetype_count() const;
+
+        /// @brief Gets the current change tick, see Registry::tick().
+        /// @return The current tick.
+        [[nodiscard]] tick_t tick() const;
+
+        /// @brief Advances the change tick, done by the simulation at the start of every cycle.
+        void advance_tick();
+
+        /// @brief Gets the entities whose component of a type was removed since the previous tick.
+        /// @tparam C The component type, whose changes must be tracked, see track_changes.
+        /// @return The IDs of the entities, in removal order. They may have been removed from the registry.
+        template<typename C>
+        [[nodiscard]] std::vector<id_t> removed() const;
+
+        /// @brief Checks if an alive entity has a specific component.
+        /// @tparam C The component type.
+        /// @param entity_id The ID of the entity.
+        /// @return Whether the entity is alive and has the component.
+        template<typename C>
+        [[nodiscard]] bool has(id_t entity_id) const;
+
+        /// @brief Gets the signature of an entity, the set of component IDs it has.
+        /// @param entity_id The ID of the entity.
+        /// @return The signature of the entity, empty if the entity is not alive.
+        [[nodiscard]] Signature signature(id_t entity_id) const;
+
+        /// @brief Gets a component of an entity.
+        /// @throws std::out_of_range if the entity doesn't have the component.
+        /// @tparam C The component type.
+        /// @param entity_id The ID of the entity.
+        /// @return A reference (or a reference proxy) to the component.
+        template<typename C>
+        [[nodiscard]] reference_t<C> get(id_t entity_id);
+
+        /// @brief Gets a component of an entity.
+        /// @throws std::out_of_range if the entity doesn't have the component.
+        /// @tparam C The component type.
+        /// @param entity_id The ID of the entity.
+        /// @return A const reference (or a reference proxy) to the component.
+        template<typename C>
+        [[nodiscard]] const_reference_t<C> get(id_t entity_id) const;
+
+        /// @brief Pushes a component to an entity, moving it to the matching archetype.
+        /// If the entity already has the component, its value is replaced.
+        /// @tparam C The component type.
+        /// @param entity The entity to which the component is added.
+        /// @param component The component to add.
+        template<typename C>
+        void push_back(const_entity_type entity, C&& component);
+
+        /// @brief Emplaces a component to an entity, moving it to the matching archetype.
+        /// If the entity already has the component, its value is replaced.
+        /// @tparam Component The component type.
+        /// @param entity The entity to which the component is added.
+        /// @param args The arguments to construct the component.
+        template<typename Component, typename... Args>
+        void emplace(const_entity_type entity, Args&&... args);
+
+        /// @brief Emplaces a component constructed from the same arguments to each of the given entities.
+        /// @tparam Component The component type.
+        /// @param entity_ids The IDs of the entities to which the component is added.
+        /// @param args The arguments passed to every component constructor.
+        template<typename Component, typename... Args>
+        void emplace_many(std::span<const id_t> entity_ids, const Args&... args);
+
+        /// @brief Pushes a range of components, one to each of the given entities.
+        /// @throws std::invalid_argument if the number of components doesn't match the number of IDs.
+        /// @tparam Component The component type.
+        /// @param entity_ids The IDs of the entities to which the components are added.
+        /// @param components The components to add, in the same order as the IDs, moved if the range owns them.
+        template<typename Component, std::ranges::sized_range R>
+        void insert(std::span<const id_t> entity_ids, R&& components);
+
+        /// @brief Pushes a component produced by a generator to each of the given entities.
+        /// @tparam Component The component type.
+        /// @param entity_ids The IDs of the entities to which the components are added.
+        /// @param generator Called in order of the IDs, either with no arguments or with the entity ID.
+        template<typename Component>
+        void generate(std::span<const id_t> entity_ids, auto&& generator);
+
+        /// @brief Removes an entity with all its components and releases its ID for reuse.
+        /// The row is only marked as removed until compaction. Removing an entity that is not alive does nothing.
+        /// @param entity The entity to remove.
+        void remove(const_entity_type entity);
+
+        /// @brief Removes a component from an entity, moving it to the matching archetype.
+        /// Removing a component the entity doesn't have does nothing.
+        /// @tparam C The component type.
+        /// @param entity The entity from which the component is removed.
+        template<typename C>
+        void remove(const_entity_type entity);
+
+        /// @brief Creates an immutable view over a set of components.
+        /// @tparam Cs The component types to include in the view.
+        /// @param filters Optional exclude and optional filters, e.g. `view<Transform>(exclude<Movable>)`.
+        /// Added and changed filters don't compile, as rows keep no change ticks.
+        /// @return An immutable view over the archetypes having all the components.
+        template<typename... Cs, typename... Fs>
+        [[nodiscard]] ArchetypeView<true, detail::optional_filter_t<Fs...>, Cs...> view(Fs... filters) const;
+
+        /// @brief Creates a mutable view over a set of components.
+        /// @tparam Cs The component types to include in the view.
+        /// @param filters Optional exclude and optional filters, e.g. `view<Transform>(exclude<Movable>)`.
+        /// Added and changed filters don't compile, as rows keep no change ticks.
+        /// @return A mutable view over the archetypes having all the components.
+        template<typename... Cs, typename... Fs>
+        [[nodiscard]] ArchetypeView<false, detail::optional_filter_t<Fs...>, Cs...> view(Fs... filters);
+
+        /// @brief Creates a mutable view over a set of components.
+        /// @details Archetype tables already keep the components of each entity at the same row,
+        /// so this is the counterpart of Registry::group() and declares nothing.
+        /// @tparam Cs The component types to include in the view.
+        /// @return A mutable view over the archetypes having all the components.
+        template<typename... Cs>
+        [[nodiscard]] ArchetypeView<false, optional_t<>, Cs...> group();
+
+        /// @brief Compacts all archetypes, removing tombstone rows. Invalidates all iterators and references.
+        void compact_all();
+
+        /// @brief Incrementally compacts archetypes within the budget of a policy. Invalidates all iterators and references.
+        /// @param policy The compaction policy.
+        /// @return The number of tombstones removed.
+        size_t compact(const CompactionPolicy& policy);
+
+        /// @brief Sorts the rows of every archetype containing a component by a key computed from it.
+        /// @details Rows of an archetype already keep all components of an entity together,
+        /// so Others are accepted for interface parity with Registry::sort_by() but need no extra work.
+        /// Compacts the sorted archetypes. Invalidates all iterators and references.
+        /// @tparam C The component type the key is computed from.
+        /// @tparam Others The component types that follow the order of C.
+        /// @param key Called with each component of type C, returns a totally ordered key.
+        template<typename C, typename... Others>
+        void sort_by(auto&& key);
+
+    private:
+        // Moves an entity to the archetype with one more component, returning its new location
+        template<typename C>
+        Location& extend(id_t entity_id);
+
+        // Moves an entity to the archetype with one less component, returning its new location
+        Location& shrink(id_t entity_id, component_id_t component_id);
+
+        // Finds the archetype with exactly the given components, or nullptr if there is none yet
+        Archetype* find(const Signature& signature) const;
+
+        // Collects the archetypes having all the given components and none of the excluded ones
+        template<typename... Cs>
+        std::vector<Archetype*> matching(const Signature& excluded) const;
+
+        // Compacts an archetype, keeping the locations of moved entities up to date
+        size_t compact(Archetype& archetype, size_t budget);
+    };
+
+    /// @brief A lightweight view over the archetypes containing a specific set of components.
+    /// @details Exclusion filters are resolved once per archetype when the view is created.
+    /// @tparam Imm Whether the view is immutable (true) or mutable (false).
+    /// @tparam Os The optional component types, see optional_t.
+    /// @tparam Cs The component types to include in the view, const qualified to only read them.
+    template<bool Imm, typename... Os, typename... Cs>
+    class ArchetypeView<Imm, optional_t<Os...>, Cs...> {
+        std::vector<Archetype*> archetypes_;
+        ArchetypeRegistry* registry_;
+
+    public:
+        /// @brief Constructs a view over the given archetypes.
+        /// @param archetypes The archetypes having all the components of the view.
+        /// @param registry A pointer to the registry managing the entities.
+        explicit ArchetypeView(std::vector<Archetype*> archetypes, ArchetypeRegistry* registry);
+
+        /// @brief Calls the given callable for each entity in the view.
+        /// @details The callable should accept all the components in the view as references to const,
+        /// followed by a pointer to const for each optional component, null if the entity doesn't have it.
+        /// It can also optionally accept the entity itself as the first argument.
+        /// @param callable The callable to call for each entity.
+        void for_each(auto&& callable) const;
+
+        /// @brief Calls the given callable for each entity in the view.
+        /// @details The callable should accept all the components in the view as arguments, and can modify them,
+        /// followed by a pointer for each optional component, null if the entity doesn't have it.
+        /// It can also optionally accept the entity itself as the first argument.
+        /// @param callable The callable to call for each entity.
+        void for_each(auto&& callable) requires (!Imm);
+
+        /// @brief Calls the given callable for each entity in the view, in parallel on a thread pool.
+        /// @details The rows of all the archetypes are split into chunks of the grain size, run as tasks of the pool.
+        /// See View::par_for_each() for the accepted callables and their restrictions.
+        /// @param pool The thread pool running the chunks.
+        /// @param callable The callable to call for each entity.
+        /// @param grain The number of rows per chunk.
+        /// @param seed The seed from which the random generator of every chunk is derived.
+        void par_for_each(ThreadPool& pool, auto&& callable, size_t grain = ThreadPool::DEFAULT_GRAIN,
+                          uint64_t seed = 0) const;
+
+        /// @brief Calls the given callable for each entity in the view, in parallel on a thread pool.
+        /// @details Like the const overload, but the callable can modify the components.
+        /// @param pool The thread pool running the chunks.
+        /// @param callable The callable to call for each entity.
+        /// @param grain The number of rows per chunk.
+        /// @param seed The seed from which the random generator of every chunk is derived.
+        void par_for_each(ThreadPool& pool, auto&& callable, size_t grain = ThreadPool::DEFAULT_GRAIN,
+                          uint64_t seed = 0) requires (!Imm);
+
+        /// @brief Calls the given callable for each contiguous run of rows in the archetypes of the view.
+        /// @details The callable should accept a span of const components per component type,
+        /// and can optionally accept the span of entity IDs first. Runs end at removed rows.
+        /// Stable components are accepted too, as archetype columns store them in a DensePool.
+        /// The callable must not add or remove components.
+        /// @param callable The callable to call for each run.
+        /// @param max_size The maximal number of entities per run, e.g. to split the work into tasks.
+        void each_chunk(auto&& callable, size_t max_size = std::numeric_limits<size_t>::max()) const;
+
+        /// @brief Calls the given callable for each contiguous run of rows in the archetypes of the view.
+        /// @details Like the const overload, but the callable receives mutable spans of components.
+        /// @param callable The callable to call for each run.
+        /// @param max_size The maximal number of entities per run, e.g. to split the work into tasks.
+        void each_chunk(auto&& callable, size_t max_size = std::numeric_limits<size_t>::max()) requires (!Imm);
+
+        /// @brief Collects the entities of the view into a vector, a sized, random-access range.
+        /// @details See View::collect().
+        /// @return Const handles to the entities, in the order of the view iterators.
+        [[nodiscard]] std::vector<ArchetypeRegistry::const_entity_type> collect() const;
+
+        /// @brief Collects the entities of the view into a vector, a sized, random-access range.
+        /// @details Like the const overload, but the handles can modify the entities.
+        /// @return Handles to the entities, in the order of the view iterators.
+        [[nodiscard]] std::vector<ArchetypeRegistry::entity_type> collect() requires (!Imm);
+
+        /// @brief Get the number of entities in the view, counted from the live rows of its archetypes.
+        /// @return The number of entities in the view.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Checks if the view is empty.
+        /// @return Whether the view contains any entities.
+        [[nodiscard]] bool empty() const;
+
+        template<bool Const>
+        struct iterator_base;
+
+        /// @brief A constant iterator for the view.
+        using const_iterator = iterator_base<true>;
+        /// @brief A mutable iterator for the view.
+        using iterator = iterator_base<false>;
+
+        /// @brief Returns a constant iterator to the beginning of the view.
+        /// @return A constant iterator to the first entity in the view.
+        [[nodiscard]] const_iterator begin() const;
+
+        /// @brief Returns a constant iterator to the end of the view.
+        /// @return A constant iterator to the end of the view.
+        [[nodiscard]] const_iterator end() const;
+
+        /// @brief Returns a mutable iterator to the beginning of the view.
+        /// @return A mutable iterator to the first entity in the view.
+        [[nodiscard]] iterator begin() requires (!Imm);
+
+        /// @brief Returns a mutable iterator to the end of the view.
+        /// @return A mutable iterator to the end of the view.
+        [[nodiscard]] iterator end() requires (!Imm);
+
+    private:
+        template<bool Const>
+        void for_each_impl(auto&& callable) const;
+
+        template<bool Const>
+        void par_for_each_impl(ThreadPool& pool, auto&& callable, size_t grain, uint64_t seed) const;
+
+        // Calls the callable for the live rows of an archetype in [begin, end), after the leading arguments
+        template<bool Const>
+        void visit_rows(Archetype* archetype, size_t begin, size_t end, auto&& callable, auto&... leading) const;
+
+        template<bool Const>
+        void each_chunk_impl(auto&& callable, size_t max_size) const;
+
+        template<bool Const>
+        auto collect_impl() const;
+    };
+
+    /// @brief Archetype view iterator, walking the rows of all matching archetypes.
+    /// @tparam Imm Whether the view is immutable (true) or mutable (false).
+    /// @tparam Cs The component types in the view.
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    struct ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base {
+    private:
+        using entity_t = std::conditional_t<Const, ArchetypeRegistry::const_entity_type,
+            ArchetypeRegistry::entity_type>;
+
+    public:
+        using value_type = entity_t;
+        using reference = entity_t;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag; // Dereferencing yields handles by value
+        using iterator_concept = std::forward_iterator_tag;
+
+    private:
+        const ArchetypeView* view_ = nullptr;
+        size_t archetype_ = 0;
+        size_t row_ = 0;
+
+    public:
+        /// @brief The default constructor creates an invalid iterator.
+        iterator_base() = default;
+
+        /// @brief Constructs an iterator for the given view, positioned at a row of one of its archetypes.
+        explicit iterator_base(const ArchetypeView* view, size_t archetype, size_t row);
+
+        /// @brief Checks if this iterator is equal to another iterator.
+        /// @param other The other iterator to compare with.
+        /// @return Whether the two iterators are equal.
+        bool operator==(const iterator_base& other) const;
+
+        /// @brief Dereferences the iterator to get the current entity.
+        /// @return A reference to the current entity.
+        [[nodiscard]] reference operator*() const;
+
+        /// @brief Pre-increments the iterator to the next entity.
+        /// @return A reference to this iterator after incrementing.
+        iterator_base& operator++();
+
+        /// @brief Post-increments the iterator to the next entity.
+        /// @return A copy of this iterator before incrementing.
+        iterator_base operator++(int);
+
+    private:
+        // Advances the iterator until it points to a valid entity.
+        void advance_till_valid();
+    };
+
+    template<>
+    constexpr bool has_change_ticks_v<ArchetypeRegistry> = false;
+
+    /// @brief The context of an archetype based registry.
+    using ArchetypeContext = BasicContext<ArchetypeRegistry>;
+
+    template<typename Reg, typename... Ss>
+    class BasicSimulation;
+
+    /// @brief A simulation using the archetype based registry, defined by including Simulation.h.
+    /// @tparam Ss The systems that will be used in the simulation.
+    template<typename... Ss>
+    using ArchetypeSimulation = BasicSimulation<ArchetypeRegistry, Ss...>;
+
+    // Implementation ============================================================================
+
+    template<typename T>
+    auto&& ArchetypeColumn<T>::pool(this auto&& self) {
+        return self.pool_;
+    }
+
+    template<typename T>
+    std::unique_ptr<ArchetypeColumnBase> ArchetypeColumn<T>::make_empty() const {
+        return std::make_unique<ArchetypeColumn>();
+    }
+
+    template<typename T>
+    void ArchetypeColumn<T>::move_from(ArchetypeColumnBase& source, const size_t row) {
+        pool_.emplace_back(std::move(static_cast<ArchetypeColumn&>(source).pool_[row]));
+    }
+
+    template<typename T>
+    void ArchetypeColumn<T>::swap_remove(const size_t row) {
+        pool_.swap(row, pool_.size() - 1);
+        pool_.pop_back();
+    }
+
+    template<typename T>
+    void ArchetypeColumn<T>::reserve(const size_t n) {
+        pool_.reserve(n);
+    }
+
+    template<typename T>
+    void ArchetypeColumn<T>::permute(const std::span<const size_t> order) {
+        std::vector<size_t> remaining(order.begin(), order.end());
+        detail::permute(remaining, [this](const size_t a, const size_t b) { pool_.swap(a, b); });
+    }
+
+    inline Archetype::Archetype(const Signature& signature):
+        signature_(signature), column_of_(MAX_COMPONENTS, NO_COLUMN) {}
+
+    inline void Archetype::add_column(const component_id_t component_id, std::unique_ptr<ArchetypeColumnBase> column) {
+        column_of_[component_id] = columns_.size();
+        columns_.push_back(std::move(column));
+        column_components_.push_back(component_id);
+    }
+
+    inline const Signature& Archetype::signature() const {
+        return signature_;
+    }
+
+    inline size_t Archetype::size() const {
+        return entities_.size();
+    }
+
+    inline size_t Archetype::tombstones() const {
+        return tombstones_;
+    }
+
+    inline const std::vector<id_t>& Archetype::entities() const {
+        return entities_;
+    }
+
+    template<typename C>
+    auto&& Archetype::pool(this auto&& self) {
+        using column_t = std::conditional_t<std::is_const_v<std::remove_reference_t<decltype(self)> >
+                                            || std::is_const_v<C>,
+            const ArchetypeColumn<std::remove_const_t<C> >, ArchetypeColumn<std::remove_const_t<C> > >;
+        return static_cast<column_t&>(*self.columns_[self.column_of_[get_component_id<C>()]]).pool();
+    }
+
+    inline Archetype* Archetype::add_edge(const component_id_t component_id) const {
+        for (const auto& [edge_component, archetype]: add_edges_)
+            if (edge_component == component_id)
+                return archetype;
+        return nullptr;
+    }
+
+    inline void Archetype::set_add_edge(const component_id_t component_id, Archetype* archetype) {
+        add_edges_.emplace_back(component_id, archetype);
+    }
+
+    inline Archetype* Archetype::remove_edge(const component_id_t component_id) const {
+        for (const auto& [edge_component, archetype]: remove_edges_)
+            if (edge_component == component_id)
+                return archetype;
+        return nullptr;
+    }
+
+    inline void Archetype::set_remove_edge(const component_id_t component_id, Archetype* archetype) {
+        remove_edges_.emplace_back(component_id, archetype);
+    }
+
+    template<typename C>
+    std::unique_ptr<Archetype> Archetype::extended() const {
+        Signature signature = signature_;
+        signature.set(get_component_id<C>());
+
+        auto archetype = std::make_unique<Archetype>(signature);
+        for (size_t i = 0; i < columns_.size(); ++i)
+            archetype->add_column(column_components_[i], columns_[i]->make_empty());
+        archetype->add_column(get_component_id<C>(), std::make_unique<ArchetypeColumn<C> >());
+        return archetype;
+    }
+
+    inline std::unique_ptr<Archetype> Archetype::reduced(const component_id_t component_id) const {
+        Signature signature = signature_;
+        signature.reset(component_id);
+
+        auto archetype = std::make_unique<Archetype>(signature);
+        for (size_t i = 0; i < columns_.size(); ++i)
+            if (column_components_[i] != component_id)
+                archetype->add_column(column_components_[i], columns_[i]->make_empty());
+        return archetype;
+    }
+
+    inline size_t Archetype::append(const id_t entity_id) {
+        entities_.push_back(entity_id);
+        return entities_.size() - 1;
+    }
+
+    inline size_t Archetype::append_from(Archetype& source, const size_t row, const id_t entity_id) {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            const uint32_t source_column = source.column_of_[column_components_[i]];
+            if (source_column != NO_COLUMN)
+                columns_[i]->move_from(*source.columns_[source_column], row);
+        }
+        return append(entity_id);
+    }
+
+    inline void Archetype::tombstone(const size_t row) {
+        entities_[row] = NO_ID;
+        holes_.push_back(row);
+        ++tombstones_;
+    }
+
+    size_t Archetype::compact(const size_t budget, auto&& moved) {
+        size_t removed = 0;
+        while (removed < budget && !holes_.empty()) {
+            const size_t hole = holes_.back();
+            holes_.pop_back();
+            if (hole >= entities_.size() || entities_[hole] != NO_ID)
+                continue; // Already compacted away or refilled
+
+            for (const auto& column: columns_)
+                column->swap_remove(hole);
+            std::swap(entities_[hole], entities_.back());
+            entities_.pop_back();
+            --tombstones_;
+            ++removed;
+
+            if (hole < entities_.size()) {
+                if (entities_[hole] == NO_ID)
+                    holes_.push_back(hole); // The last row was a tombstone as well
+                else
+                    moved(entities_[hole], hole);
+            }
+        }
+        return removed;
+    }
+
+    inline void Archetype::reserve(const size_t n) {
+        entities_.reserve(entities_.size() + n);
+        for (const auto& column: columns_)
+            column->reserve(entities_.size() + n);
+    }
+
+    template<typename C>
+    void Archetype::sort_by(auto&& key, auto&& moved) {
+        compact(std::numeric_limits<size_t>::max(), moved);
+
+        const auto& components = std::as_const(*this).pool<C>();
+        std::vector<std::decay_t<decltype(key(components[0]))> > keys;
+        keys.reserve(entities_.size());
+        for (size_t row = 0; row < entities_.size(); ++row)
+            keys.push_back(key(components[row]));
+
+        std::vector<size_t> order(entities_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order, {}, [&](const size_t row) -> const auto& { return keys[row]; });
+
+        for (const auto& column: columns_)
+            column->permute(order);
+        detail::permute(order, [this](const size_t a, const size_t b) { std::swap(entities_[a], entities_[b]); });
+        for (size_t row = 0; row < entities_.size(); ++row)
+            moved(entities_[row], row);
+    }
+
+    template<typename C>
+    component_id_t ArchetypeRegistry::component_id() {
+        const component_id_t id = get_component_id<C>();
+        if (id >= MAX_COMPONENTS)
+            throw std::length_error("Too many component types, increase SIM_MAX_COMPONENTS");
+        return id;
+    }
+
+    inline ArchetypeRegistry::ArchetypeRegistry() {
+        archetypes_.push_back(std::make_unique<Archetype>(Signature{}));
+    }
+
+    inline ArchetypeRegistry::entity_type ArchetypeRegistry::create() {
+        const id_t id = ids_.create();
+        if (to_index(id) >= locations_.size())
+            locations_.resize(to_index(id) + 1);
+        locations_[to_index(id)] = {archetypes_.front().get(), archetypes_.front()->append(id)};
+        return {id, this};
+    }
+
+    inline BasicEntityBatch<ArchetypeRegistry> ArchetypeRegistry::create_many(const size_t n) {
+        std::vector<id_t> ids;
+        ids_.create_many(n, ids);
+        if (ids_.capacity() > locations_.size())
+            locations_.resize(ids_.capacity());
+
+        Archetype& root = *archetypes_.front();
+        root.reserve(n);
+        for (const id_t id: ids)
+            locations_[to_index(id)] = {&root, root.append(id)};
+        return {std::move(ids), this};
+    }
+
+    inline bool ArchetypeRegistry::alive(const id_t entity_id) const {
+        return ids_.alive(entity_id);
+    }
+
+    inline size_t ArchetypeRegistry::size() const {
+        return ids_.size();
+    }
+
+    inline size_t ArchetypeRegistry::archetype_count() const {
+        return archetypes_.size();
+    }
+
+    inline tick_t ArchetypeRegistry::tick() const {
+        return tick_;
+    }
+
+    inline void ArchetypeRegistry::advance_tick() {
+        ++tick_;
+        for (auto& removals: removed_)
+            std::erase_if(removals, [&](const auto& removal) { return removal.second + 1 < tick_; });
+    }
+
+    template<typename C>
+    std::vector<id_t> ArchetypeRegistry::removed() const {
+        static_assert(is_tracked_v<C>, "Removals are only recorded for components opting in to change tracking");
+        std::vector<id_t> removed;
+        if (const component_id_t id = component_id<C>(); id < removed_.size())
+            for (const auto& [entity_id, tick]: removed_[id])
+                if (tick + 1 >= tick_)
+                    removed.push_back(entity_id);
+        return removed;
+    }
+
+    template<typename C>
+    bool ArchetypeRegistry::has(const id_t entity_id) const {
+        return ids_.alive(entity_id)
+               && locations_[to_index(entity_id)].archetype->signature().test(component_id<C>());
+    }
+
+    inline Signature ArchetypeRegistry::signature(const id_t entity_id) const {
+        return ids_.alive(entity_id) ? locations_[to_index(entity_id)].archetype->signature() : Signature{};
+    }
+
+    template<typename C>
+    reference_t<C> ArchetypeRegistry::get(const id_t entity_id) {
+        if (!has<C>(entity_id)) // TODO: only in debug
+            throw std::out_of_range("No component for entity with this ID");
+        const auto& [archetype, row] = locations_[to_index(entity_id)];
+        return archetype->pool<C>()[row];
+    }
+
+    template<typename C>
+    const_reference_t<C> ArchetypeRegistry::get(const id_t entity_id) const {
+        if (!has<C>(entity_id)) // TODO: only in debug
+            throw std::out_of_range("No component for entity with this ID");
+        const auto& [archetype, row] = locations_[to_index(entity_id)];
+        return std::as_const(*archetype).pool<C>()[row];
+    }
+
+    template<typename C>
+    void ArchetypeRegistry::push_back(const const_entity_type entity, C&& component) {
+        emplace<std::decay_t<C> >(entity, std::forward<C>(component));
+    }
+
+    template<typename Component, typename... Args>
+    void ArchetypeRegistry::emplace(const const_entity_type entity, Args&&... args) {
+        if (has<Component>(entity.id())) {
+            get<Component>(entity.id()) = Component(std::forward<Args>(args)...);
+            return;
+        }
+        const Location& location = extend<Component>(entity.id());
+        location.archetype->pool<Component>().emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename Component, typename... Args>
+    void ArchetypeRegistry::emplace_many(const std::span<const id_t> entity_ids, const Args&... args) {
+        for (const id_t entity_id: entity_ids)
+            emplace<Component>(const_entity_type(entity_id, this), args...);
+    }
+
+    template<typename Component, std::ranges::sized_range R>
+    void ArchetypeRegistry::insert(const std::span<const id_t> entity_ids, R&& components) {
+        if (std::ranges::size(components) != entity_ids.size())
+            throw std::invalid_argument("Number of components doesn't match the number of entities");
+        auto it = std::ranges::begin(components);
+        for (const id_t entity_id: entity_ids) {
+            emplace<Component>(const_entity_type(entity_id, this), detail::take_element<R>(it));
+            ++it;
+        }
+    }
+
+    template<typename Component>
+    void ArchetypeRegistry::generate(const std::span<const id_t> entity_ids, auto&& generator) {
+        for (const id_t entity_id: entity_ids) {
+            if constexpr (std::invocable<decltype(generator), id_t>)
+                emplace<Component>(const_entity_type(entity_id, this), generator(entity_id));
+            else
+                emplace<Component>(const_entity_type(entity_id, this), generator());
+        }
+    }
+
+    inline void ArchetypeRegistry::remove(const const_entity_type entity) { // NOLINT
+        if (!ids_.release(entity.id())) return;
+        const auto& [archetype, row] = locations_[to_index(entity.id())];
+        archetype->signature().for_each([&](const component_id_t component_id) {
+            if (tracked_.test(component_id))
+                removed_[component_id].emplace_back(entity.id(), tick_);
+        });
+        archetype->tombstone(row);
+    }
+
+    template<typename C>
+    void ArchetypeRegistry::remove(const const_entity_type entity) { // NOLINT
+        if (!has<C>(entity.id())) return;
+        const component_id_t id = component_id<C>();
+        if (tracked_.test(id))
+            removed_[id].emplace_back(entity.id(), tick_);
+        shrink(entity.id(), id);
+    }
+
+    template<typename... Cs, typename... Fs>
+    ArchetypeView<true, detail::optional_filter_t<Fs...>, Cs...> ArchetypeRegistry::view(Fs... filters) const {
+        static_assert(!(detail::is_tick_filter_v<Fs> || ...), "Archetype rows keep no change ticks to filter by");
+        Signature excluded;
+        (detail::add_excluded<ArchetypeRegistry>(excluded, filters), ...);
+        // Immutable views only hand out const entity handles, which never modify the registry
+        return ArchetypeView<true, detail::optional_filter_t<Fs...>, Cs...>(
+            matching<Cs...>(excluded), const_cast<ArchetypeRegistry*>(this));
+    }
+
+    template<typename... Cs, typename... Fs>
+    ArchetypeView<false, detail::optional_filter_t<Fs...>, Cs...> ArchetypeRegistry::view(Fs... filters) {
+        static_assert(!(detail::is_tick_filter_v<Fs> || ...), "Archetype rows keep no change ticks to filter by");
+        Signature excluded;
+        (detail::add_excluded<ArchetypeRegistry>(excluded, filters), ...);
+        return ArchetypeView<false, detail::optional_filter_t<Fs...>, Cs...>(matching<Cs...>(excluded), this);
+    }
+
+    template<typename... Cs>
+    ArchetypeView<false, optional_t<>, Cs...> ArchetypeRegistry::group() {
+        return view<Cs...>();
+    }
+
+    inline void ArchetypeRegistry::compact_all() {
+        for (const auto& archetype: archetypes_)
+            compact(*archetype, std::numeric_limits<size_t>::max());
+    }
+
+    inline size_t ArchetypeRegistry::compact(const CompactionPolicy& policy) {
+        using clock = std::chrono::steady_clock;
+        const bool timed = policy.time_budget.count() > 0;
+        const auto deadline = clock::now() + policy.time_budget;
+        const size_t budget = policy.element_budget == 0 ? std::numeric_limits<size_t>::max() : policy.element_budget;
+
+        size_t removed = 0;
+        for (size_t n = 0; n < archetypes_.size(); ++n) {
+            const size_t current = (compaction_cursor_ + n) % archetypes_.size();
+            Archetype& archetype = *archetypes_[current];
+            if (archetype.tombstones() == 0
+                || static_cast<double>(archetype.tombstones()) < policy.min_tombstone_ratio * archetype.size())
+                continue;
+
+            removed += compact(archetype, budget - removed);
+            if (removed >= budget || (timed && clock::now() >= deadline)) {
+                compaction_cursor_ = current; // Out of budget, continue here next time
+                return removed;
+            }
+        }
+        return removed;
+    }
+
+    template<typename C, typename... Others>
+    void ArchetypeRegistry::sort_by(auto&& key) {
+        for (const auto& archetype: archetypes_) {
+            if (!archetype->signature().test(component_id<C>()) || archetype->size() == 0) continue;
+            archetype->sort_by<C>(key, [this](const id_t moved_id, const size_t row) {
+                locations_[to_index(moved_id)].row = row;
+            });
+        }
+    }
+
+    template<typename C>
+    ArchetypeRegistry::Location& ArchetypeRegistry::extend(const id_t entity_id) {
+        const component_id_t id = component_id<C>();
+        if constexpr (is_tracked_v<C>) {
+            tracked_.set(id);
+            if (id >= removed_.size())
+                removed_.resize(id + 1);
+        }
+
+        Location& location = locations_[to_index(entity_id)];
+        Archetype* source = location.archetype;
+        Archetype* target = source->add_edge(id);
+
+        if (!target) {
+            Signature signature = source->signature();
+            signature.set(id);
+            target = find(signature);
+            if (!target) {
+                archetypes_.push_back(source->extended<C>());
+                target = archetypes_.back().get();
+            }
+            source->set_add_edge(id, target);
+        }
+
+        const size_t row = target->append_from(*source, location.row, entity_id);
+        source->tombstone(location.row);
+        location = {target, row};
+        return location;
+    }
+
+    // The removed component stays in the tombstone row of the source until compaction
+    inline ArchetypeRegistry::Location& ArchetypeRegistry::shrink(const id_t entity_id,
+                                                                  const component_id_t component_id) {
+        Location& location = locations_[to_index(entity_id)];
+        Archetype* source = location.archetype;
+        Archetype* target = source->remove_edge(component_id);
+
+        if (!target) {
+            Signature signature = source->signature();
+            signature.reset(component_id);
+            target = find(signature);
+            if (!target) {
+                archetypes_.push_back(source->reduced(component_id));
+                target = archetypes_.back().get();
+            }
+            source->set_remove_edge(component_id, target);
+        }
+
+        const size_t row = target->append_from(*source, location.row, entity_id);
+        source->tombstone(location.row);
+        location = {target, row};
+        return location;
+    }
+
+    inline Archetype* ArchetypeRegistry::find(const Signature& signature) const {
+        const auto existing = std::ranges::find_if(archetypes_, [&](const auto& archetype) {
+            return archetype->signature() == signature;
+        });
+        return existing != archetypes_.end() ? existing->get() : nullptr;
+    }
+
+    template<typename... Cs>
+    std::vector<Archetype*> ArchetypeRegistry::matching(const Signature& excluded) const {
+        Signature required;
+        (required.set(component_id<Cs>()), ...);
+
+        std::vector<Archetype*> archetypes;
+        for (const auto& archetype: archetypes_)
+            if (archetype->signature().contains(required) && !archetype->signature().intersects(excluded))
+                archetypes.push_back(archetype.get());
+        return archetypes;
+    }
+
+    inline size_t ArchetypeRegistry::compact(Archetype& archetype, const size_t budget) {
+        return archetype.compact(budget, [this](const id_t moved_id, const size_t row) {
+            locations_[to_index(moved_id)].row = row;
+        });
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    ArchetypeView<Imm, optional_t<Os...>, Cs...>::ArchetypeView(std::vector<Archetype*> archetypes, ArchetypeRegistry* registry):
+        archetypes_(std::move(archetypes)), registry_(registry) {}
+
+    template<bool Imm, typename... Os, typename... Cs>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::for_each(auto&& callable) const {
+        for_each_impl<true>(std::forward<decltype(callable)>(callable));
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::for_each(auto&& callable) requires (!Imm) {
+        for_each_impl<false>(std::forward<decltype(callable)>(callable));
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::for_each_impl(auto&& callable) const {
+        for (Archetype* archetype: archetypes_)
+            visit_rows<Const>(archetype, 0, std::numeric_limits<size_t>::max(), callable);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::par_for_each(ThreadPool& pool, auto&& callable,
+                                                                     const size_t grain, const uint64_t seed) const {
+        par_for_each_impl<true>(pool, std::forward<decltype(callable)>(callable), grain, seed);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::par_for_each(ThreadPool& pool, auto&& callable,
+                                                                     const size_t grain, const uint64_t seed)
+        requires (!Imm) {
+        par_for_each_impl<false>(pool, std::forward<decltype(callable)>(callable), grain, seed);
+    }
+
+    // Chunks are cut from the rows of all archetypes laid end to end, so a chunk may span several archetypes
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::par_for_each_impl(ThreadPool& pool, auto&& callable,
+                                                                          const size_t grain,
+                                                                          const uint64_t seed) const {
+        std::vector<size_t> offsets{0}; // First global row of each archetype
+        for (const Archetype* archetype: archetypes_)
+            offsets.push_back(offsets.back() + archetype->entities().size());
+
+        pool.parallel_for(offsets.back(), grain, seed, [&](Chunk& chunk) {
+            size_t a = std::ranges::upper_bound(offsets, chunk.begin) - offsets.begin() - 1;
+            for (; a < archetypes_.size() && offsets[a] < chunk.end; ++a)
+                visit_rows<Const>(archetypes_[a], std::max(chunk.begin, offsets[a]) - offsets[a],
+                                  std::min(chunk.end, offsets[a + 1]) - offsets[a], callable, chunk);
+        });
+    }
+
+    // Optional columns are looked up once per call, null if the archetype lacks them.
+    // Rows appended during the iteration (e.g. by adding components) are visited too, up to the end.
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::visit_rows(Archetype* archetype, const size_t begin,
+                                                                   const size_t end, auto&& callable,
+                                                                   auto&... leading) const {
+        using entity_t = std::conditional_t<Const, ArchetypeRegistry::const_entity_type,
+            ArchetypeRegistry::entity_type>;
+        using archetype_t = std::conditional_t<Const, const Archetype, Archetype>;
+
+        archetype_t* table = archetype;
+        const std::tuple pools{&table->template pool<Cs>()...};
+        const std::tuple optional_pools{
+            table->signature().test(ArchetypeRegistry::component_id<Os>()) ? &table->template pool<Os>() : nullptr...
+        };
+        const std::vector<id_t>& entities = table->entities();
+
+        for (size_t row = begin; row < std::min(end, entities.size()); ++row) {
+            if (entities[row] == NO_ID) continue;
+            entity_t entity(entities[row], registry_);
+            // The leading arguments are unpacked from a tuple, as nested lambdas can't capture the parameter pack
+            std::apply([&](auto&... leading_arg) {
+                std::apply([&](auto*... pool) {
+                    std::apply([&](auto*... optional_pool) {
+                        // The entity is preferred over the leading arguments, as in View::visit()
+                        if constexpr (requires {
+                            callable(leading_arg..., entity, (*pool)[row]..., &(*optional_pool)[row]...);
+                        })
+                            callable(leading_arg..., entity, (*pool)[row]...,
+                                     optional_pool ? &(*optional_pool)[row] : nullptr...);
+                        else if constexpr (requires { callable(entity, (*pool)[row]..., &(*optional_pool)[row]...); })
+                            callable(entity, (*pool)[row]..., optional_pool ? &(*optional_pool)[row] : nullptr...);
+                        else if constexpr (requires {
+                            callable(leading_arg..., (*pool)[row]..., &(*optional_pool)[row]...);
+                        })
+                            callable(leading_arg..., (*pool)[row]...,
+                                     optional_pool ? &(*optional_pool)[row] : nullptr...);
+                        else
+                            callable((*pool)[row]..., optional_pool ? &(*optional_pool)[row] : nullptr...);
+                    }, optional_pools);
+                }, pools);
+            }, std::forward_as_tuple(leading...));
+        }
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::each_chunk(auto&& callable, const size_t max_size) const {
+        each_chunk_impl<true>(std::forward<decltype(callable)>(callable), max_size);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::each_chunk(auto&& callable, const size_t max_size)
+        requires (!Imm) {
+        each_chunk_impl<false>(std::forward<decltype(callable)>(callable), max_size);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::each_chunk_impl(auto&& callable, const size_t max_size) const {
+        static_assert(sizeof...(Os) == 0, "Chunks can't hold optional components");
+        static_assert((std::is_same_v<typename ArchetypeColumn<std::remove_const_t<Cs> >::pool_type,
+                          DensePool<std::remove_const_t<Cs> > > && ...),
+                      "Chunks need all components stored in a DensePool column");
+
+        using archetype_t = std::conditional_t<Const, const Archetype, Archetype>;
+
+        for (archetype_t* archetype: archetypes_) {
+            const std::tuple pools{&archetype->template pool<Cs>()...};
+            const std::vector<id_t>& entities = archetype->entities();
+
+            for (size_t row = 0; row < entities.size();) {
+                if (entities[row] == NO_ID) {
+                    ++row;
+                    continue;
+                }
+                size_t length = 1;
+                while (length < max_size && row + length < entities.size() && entities[row + length] != NO_ID)
+                    ++length;
+
+                const std::span<const id_t> ids(entities.data() + row, length);
+                std::apply([&](auto*... pool) {
+                    if constexpr (requires { callable(ids, std::span(pool->data() + row, length)...); })
+                        callable(ids, std::span(pool->data() + row, length)...);
+                    else
+                        callable(std::span(pool->data() + row, length)...);
+                }, pools);
+                row += length;
+            }
+        }
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    std::vector<ArchetypeRegistry::const_entity_type> ArchetypeView<Imm, optional_t<Os...>, Cs...>::collect() const {
+        return collect_impl<true>();
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    std::vector<ArchetypeRegistry::entity_type> ArchetypeView<Imm, optional_t<Os...>, Cs...>::collect()
+        requires (!Imm) {
+        return collect_impl<false>();
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    auto ArchetypeView<Imm, optional_t<Os...>, Cs...>::collect_impl() const {
+        using entity_t = std::conditional_t<Const, ArchetypeRegistry::const_entity_type,
+            ArchetypeRegistry::entity_type>;
+
+        std::vector<entity_t> collected;
+        collected.reserve(size());
+        for (const Archetype* archetype: archetypes_)
+            for (const id_t entity_id: archetype->entities())
+                if (entity_id != NO_ID)
+                    collected.emplace_back(entity_id, registry_);
+        return collected;
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    size_t ArchetypeView<Imm, optional_t<Os...>, Cs...>::size() const {
+        size_t count = 0;
+        for (const Archetype* archetype: archetypes_)
+            count += archetype->size() - archetype->tombstones();
+        return count;
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    bool ArchetypeView<Imm, optional_t<Os...>, Cs...>::empty() const {
+        return size() == 0;
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::const_iterator ArchetypeView<Imm, optional_t<Os...>, Cs...>::begin() const {
+        return const_iterator(this, 0, 0);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::const_iterator ArchetypeView<Imm, optional_t<Os...>, Cs...>::end() const {
+        return const_iterator(this, archetypes_.size(), 0);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator ArchetypeView<Imm, optional_t<Os...>, Cs...>::begin() requires (!Imm) {
+        return iterator(this, 0, 0);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator ArchetypeView<Imm, optional_t<Os...>, Cs...>::end() requires (!Imm) {
+        return iterator(this, archetypes_.size(), 0);
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::iterator_base(const ArchetypeView* view, const size_t archetype,
+                                                                    const size_t row):
+        view_(view), archetype_(archetype), row_(row) {
+        advance_till_valid();
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    bool ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator==(const iterator_base& other) const {
+        return view_ == other.view_ && archetype_ == other.archetype_ && row_ == other.row_;
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::template iterator_base<Const>::reference
+    ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator*() const {
+        return {view_->archetypes_[archetype_]->entities()[row_], view_->registry_};
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::template iterator_base<Const>&
+    ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator++() {
+        ++row_;
+        advance_till_valid();
+        return *this;
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    typename ArchetypeView<Imm, optional_t<Os...>, Cs...>::template iterator_base<Const>
+    ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator++(int) {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    template<bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void ArchetypeView<Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::advance_till_valid() {
+        while (archetype_ < view_->archetypes_.size()) {
+            const auto& entities = view_->archetypes_[archetype_]->entities();
+            while (row_ < entities.size() && entities[row_] == NO_ID)
+                ++row_;
+            if (row_ < entities.size())
+                return;
+            ++archetype_;
+            row_ = 0;
+        }
+    }
+}
+
+#endif //ARCHETYPE_H
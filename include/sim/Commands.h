@@ -0,0 +1,327 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "Registry.h"
+#include "ThreadPool.h"
+
+namespace sim {
+    namespace detail {
+        // Where a command was recorded in the work as if it ran sequentially (see current_path),
+        // so commands recorded concurrently are applied in the same order whatever the scheduling
+        struct CommandOrder {
+            const std::vector<uint64_t>* path; // Path of the chunk that recorded the command
+            uint64_t step; // Step of the command within the chunk
+
+            // Compares the paths followed by the steps, lexicographically
+            [[nodiscard]] bool operator<(const CommandOrder& other) const;
+        };
+
+        // The recorded emplacements and removals of one component type, type-erased
+        template<typename Reg>
+        class CommandLaneBase {
+        public:
+            virtual ~CommandLaneBase() = default;
+
+            // Moves the commands of another lane of the same component type to the end of this one
+            virtual void absorb(CommandLaneBase& other) = 0;
+
+            // Applies the emplacements, then the removals, each in entity order, and forgets them.
+            // The last emplacement recorded for an entity wins, see CommandOrder.
+            virtual void apply(Reg& registry) = 0;
+
+            [[nodiscard]] virtual bool empty() const = 0;
+        };
+
+        template<typename Reg, typename C>
+        class CommandLane final : public CommandLaneBase<Reg> {
+            using const_entity_type = typename Reg::const_entity_type;
+
+        public:
+            struct Emplacement {
+                id_t entity_id;
+                CommandOrder order;
+                C component;
+            };
+
+            std::vector<Emplacement> emplaced;
+            std::vector<id_t> removed;
+
+            void absorb(CommandLaneBase<Reg>& other) override;
+
+            void apply(Reg& registry) override;
+
+            [[nodiscard]] bool empty() const override;
+        };
+    }
+
+    /// @brief Records structural changes (entity creation and removal, component addition and removal)
+    /// to apply them later, in one pass.
+    /// @details Adding or removing components while iterating a view invalidates it, and concurrent systems
+    /// must not touch the registry structure at all, so they record the changes here instead.
+    /// Every thread of the pool records into its own part of the buffer, without any locking. Besides them,
+    /// only the thread owning the buffer, the one that constructed it or applied it last, may record:
+    /// any other thread (e.g. a render thread or a worker of another pool) would share its part.
+    /// Commands are ordered as if the parallel loops recording them ran their chunks one after another
+    /// (see ThreadPool::parallel_for). With the Dispatcher running systems in the same loops whatever
+    /// the number of workers, the outcome doesn't depend on the number of threads or the scheduling.
+    /// The simulation applies the buffer at the end of every event (see BasicContext::commands()):
+    /// entities are created first, in that order, then the components are added and removed type by type,
+    /// sorted by entity, so every storage is visited once, front to back. The last value recorded for a component
+    /// of an entity wins. Entities are destroyed last, so an entity destroyed and given a component
+    /// in the same event ends up destroyed. Commands for entities that are no longer alive are dropped.
+    /// @tparam Reg The registry type the changes are applied to.
+    template<typename Reg>
+    class BasicCommandBuffer {
+        using const_entity_type = typename Reg::const_entity_type;
+
+        struct Creation {
+            detail::CommandOrder order;
+            std::move_only_function<void(Reg&)> create;
+        };
+
+        struct alignas(64) Shard { // Aligned so that threads don't share cache lines
+            std::vector<Creation> created;
+            std::vector<std::unique_ptr<detail::CommandLaneBase<Reg> > > lanes; // Indexed by component ID
+            std::vector<id_t> destroyed;
+            std::deque<std::vector<uint64_t> > paths; // Paths of the chunks that recorded, referred to by the orders
+            size_t count = 0; // Commands recorded since the last apply
+        };
+
+        std::vector<Shard> shards_;
+        const ThreadPool* pool_;
+        std::thread::id owner_ = std::this_thread::get_id(); // The only thread outside the pool that may record
+
+    public:
+        /// @brief Constructs an empty buffer with a part for every thread of a pool.
+        /// @param pool The thread pool whose threads record commands. Without one, only a single thread may record.
+        explicit BasicCommandBuffer(const ThreadPool* pool = nullptr);
+
+        /// @brief Records the creation of an entity with a set of components.
+        /// @throws std::logic_error if called by a thread that may not record, see the class details.
+        /// @details The entity gets its ID when the buffer is applied.
+        /// @param components The components of the new entity.
+        template<typename... Cs>
+        void create(Cs&&... components);
+
+        /// @brief Records the addition of a component to an entity, replacing its value if the entity has it.
+        /// @throws std::logic_error if called by a thread that may not record, see the class details.
+        /// @tparam C The component type.
+        /// @param entity The entity to which the component is added.
+        /// @param args The arguments to construct the component, constructed right away.
+        template<typename C, typename... Args>
+        void emplace(const_entity_type entity, Args&&... args);
+
+        /// @brief Records the removal of a component from an entity.
+        /// @throws std::logic_error if called by a thread that may not record, see the class details.
+        /// @details Removals of a type are applied after its additions, so the component is removed
+        /// even if the same event also added it.
+        /// @tparam C The component type.
+        /// @param entity The entity from which the component is removed.
+        template<typename C>
+        void remove(const_entity_type entity);
+
+        /// @brief Records the removal of an entity with all its components.
+        /// @throws std::logic_error if called by a thread that may not record, see the class details.
+        /// @param entity The entity to remove.
+        void destroy(const_entity_type entity);
+
+        /// @brief Checks if there are any commands to apply.
+        /// @return Whether no thread recorded a command since the last apply.
+        [[nodiscard]] bool empty() const;
+
+        /// @brief Applies all recorded commands to a registry and clears the buffer.
+        /// @details Must not be called while any thread records commands. The calling thread becomes
+        /// the owner of the buffer, even if there is nothing to apply.
+        /// @param registry The registry to change.
+        void apply(Reg& registry);
+
+    private:
+        // Gets the part of the buffer of the calling thread
+        Shard& shard();
+
+        // Takes a step in the work of the calling thread, ordering the command it records
+        static detail::CommandOrder order(Shard& part);
+
+        // Gets the lane of a component type in a part of the buffer, creating it on first use
+        template<typename C>
+        static detail::CommandLane<Reg, C>& lane(Shard& part);
+    };
+
+    // Implementation ============================================================================
+
+    inline bool detail::CommandOrder::operator<(const CommandOrder& other) const {
+        const auto at = [](const CommandOrder& order, const size_t i) {
+            return i < order.path->size() ? (*order.path)[i] : order.step;
+        };
+        // Neither sequence is a prefix of the other, as a step either records a command or starts a loop
+        for (size_t i = 0; i <= std::min(path->size(), other.path->size()); ++i)
+            if (at(*this, i) != at(other, i))
+                return at(*this, i) < at(other, i);
+        return false;
+    }
+
+    template<typename Reg, typename C>
+    void detail::CommandLane<Reg, C>::absorb(CommandLaneBase<Reg>& other) {
+        auto& lane = static_cast<CommandLane&>(other);
+        std::ranges::move(lane.emplaced, std::back_inserter(emplaced));
+        removed.insert(removed.end(), lane.removed.begin(), lane.removed.end());
+        lane.emplaced.clear();
+        lane.removed.clear();
+    }
+
+    template<typename Reg, typename C>
+    void detail::CommandLane<Reg, C>::apply(Reg& registry) {
+        std::ranges::sort(emplaced, [](const Emplacement& a, const Emplacement& b) {
+            return to_index(a.entity_id) != to_index(b.entity_id)
+                       ? to_index(a.entity_id) < to_index(b.entity_id)
+                       : a.order < b.order;
+        });
+        for (auto& [entity_id, order, component]: emplaced) {
+            if (!registry.alive(entity_id)) continue;
+            if (registry.template has<C>(entity_id))
+                registry.template get<C>(entity_id) = std::move(component);
+            else
+                registry.template emplace<C>(const_entity_type(entity_id, &registry), std::move(component));
+        }
+
+        std::ranges::sort(removed, {}, to_index);
+        for (const id_t entity_id: removed)
+            registry.template remove<C>(const_entity_type(entity_id, &registry));
+
+        emplaced.clear();
+        removed.clear();
+    }
+
+    template<typename Reg, typename C>
+    bool detail::CommandLane<Reg, C>::empty() const {
+        return emplaced.empty() && removed.empty();
+    }
+
+    template<typename Reg>
+    BasicCommandBuffer<Reg>::BasicCommandBuffer(const ThreadPool* pool):
+        shards_(pool ? pool->size() + 1 : 1), pool_(pool) {}
+
+    template<typename Reg>
+    template<typename... Cs>
+    void BasicCommandBuffer<Reg>::create(Cs&&... components) {
+        Shard& part = shard();
+        part.created.emplace_back(order(part), [components = std::tuple<std::decay_t<Cs>...>(
+            std::forward<Cs>(components)...)](Reg& registry) mutable {
+                auto entity = registry.create();
+                std::apply([&](auto&... component) { (entity.push_back(std::move(component)), ...); }, components);
+            });
+        ++part.count;
+    }
+
+    template<typename Reg>
+    template<typename C, typename... Args>
+    void BasicCommandBuffer<Reg>::emplace(const const_entity_type entity, Args&&... args) {
+        Shard& part = shard();
+        lane<C>(part).emplaced.push_back({entity.id(), order(part), C(std::forward<Args>(args)...)});
+        ++part.count;
+    }
+
+    template<typename Reg>
+    template<typename C>
+    void BasicCommandBuffer<Reg>::remove(const const_entity_type entity) {
+        Shard& part = shard();
+        lane<C>(part).removed.push_back(entity.id());
+        ++part.count;
+    }
+
+    template<typename Reg>
+    void BasicCommandBuffer<Reg>::destroy(const const_entity_type entity) {
+        Shard& part = shard();
+        part.destroyed.push_back(entity.id());
+        ++part.count;
+    }
+
+    template<typename Reg>
+    bool BasicCommandBuffer<Reg>::empty() const {
+        return std::ranges::all_of(shards_, [](const Shard& part) { return part.count == 0; });
+    }
+
+    template<typename Reg>
+    void BasicCommandBuffer<Reg>::apply(Reg& registry) {
+        owner_ = std::this_thread::get_id();
+        if (empty()) return;
+
+        std::vector<Creation*> created;
+        for (Shard& part: shards_)
+            for (Creation& creation: part.created)
+                created.push_back(&creation);
+        std::ranges::sort(created, [](const Creation* a, const Creation* b) { return a->order < b->order; });
+        for (Creation* creation: created)
+            creation->create(registry);
+        for (Shard& part: shards_)
+            part.created.clear();
+
+        // The lanes of a component type are merged across the threads, so its storage is visited once
+        size_t lanes = 0;
+        for (const Shard& part: shards_)
+            lanes = std::max(lanes, part.lanes.size());
+        for (component_id_t id = 0; id < lanes; ++id) {
+            detail::CommandLaneBase<Reg>* merged = nullptr;
+            for (Shard& part: shards_) {
+                if (id >= part.lanes.size() || !part.lanes[id] || part.lanes[id]->empty()) continue;
+                if (merged)
+                    merged->absorb(*part.lanes[id]);
+                else
+                    merged = part.lanes[id].get();
+            }
+            if (merged) merged->apply(registry);
+        }
+
+        std::vector<id_t>& destroyed = shards_.front().destroyed;
+        for (Shard& part: shards_ | std::views::drop(1)) {
+            destroyed.insert(destroyed.end(), part.destroyed.begin(), part.destroyed.end());
+            part.destroyed.clear();
+        }
+        std::ranges::sort(destroyed, {}, to_index);
+        for (const id_t entity_id: destroyed)
+            registry.remove(const_entity_type(entity_id, &registry)); // Duplicates are no longer alive
+        destroyed.clear();
+
+        for (Shard& part: shards_) {
+            part.paths.clear();
+            part.count = 0;
+        }
+    }
+
+    template<typename Reg>
+    typename BasicCommandBuffer<Reg>::Shard& BasicCommandBuffer<Reg>::shard() {
+        const size_t index = pool_ ? pool_->thread_index() : 0;
+        if (index == 0 && std::this_thread::get_id() != owner_)
+            throw std::logic_error("Commands can only be recorded by the threads of the pool and the owning thread");
+        return shards_[index];
+    }
+
+    template<typename Reg>
+    detail::CommandOrder BasicCommandBuffer<Reg>::order(Shard& part) {
+        if (part.paths.empty() || part.paths.back() != detail::current_path)
+            part.paths.push_back(detail::current_path);
+        return {&part.paths.back(), detail::current_step++};
+    }
+
+    template<typename Reg>
+    template<typename C>
+    detail::CommandLane<Reg, C>& BasicCommandBuffer<Reg>::lane(Shard& part) {
+        const component_id_t id = Reg::template component_id<C>();
+        if (id >= part.lanes.size())
+            part.lanes.resize(id + 1);
+        if (!part.lanes[id])
+            part.lanes[id] = std::make_unique<detail::CommandLane<Reg, C> >();
+        return static_cast<detail::CommandLane<Reg, C>&>(*part.lanes[id]);
+    }
+}
+
+#endif //COMMANDS_H
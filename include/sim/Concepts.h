@@ -1,5 +1,7 @@
 #ifndef CONCEPTS_H
 #define CONCEPTS_H
+#include <concepts>
+#include <cstddef>
 
 template<typename Item, typename... Collection>
 concept OneOf = (std::same_as<std::remove_cvref_t<Item>, Collection> || ...);
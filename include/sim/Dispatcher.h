@@ -3,10 +3,70 @@
 #include "View.h"
 
 namespace sim {
+    /// @brief A list of component types, e.g. to declare the components a system accesses.
+    /// @details A system declares `using reads = components<...>;` and `using writes = components<...>;`,
+    /// see Dispatcher. Accessing a tracked component through a mutable view marks it as changed (see track_changes),
+    /// so such components must be declared as written even if they are only read.
+    /// @tparam Cs The component types.
+    template<typename... Cs>
+    struct components {};
+
+    namespace detail {
+        template<typename S>
+        struct reads_of {
+            using type = components<>;
+        };
+
+        template<typename S> requires requires { typename S::reads; }
+        struct reads_of<S> {
+            using type = typename S::reads;
+        };
+
+        template<typename S>
+        struct writes_of {
+            using type = components<>;
+        };
+
+        template<typename S> requires requires { typename S::writes; }
+        struct writes_of<S> {
+            using type = typename S::writes;
+        };
+
+        template<typename S>
+        constexpr bool declares_access_v = requires { typename S::reads; } || requires { typename S::writes; };
+
+        template<typename C, typename... Cs>
+        constexpr bool contains_v = (std::is_same_v<C, Cs> || ...);
+
+        template<typename... As, typename... Bs>
+        constexpr bool intersects(components<As...>, components<Bs...>) {
+            return (contains_v<As, Bs...> || ...);
+        }
+
+        // Whether two systems may not run concurrently, i.e. one writes what the other accesses,
+        // or either doesn't declare its accesses
+        template<typename S1, typename S2>
+        constexpr bool conflicts_v = !declares_access_v<S1> || !declares_access_v<S2>
+                                     || intersects(typename writes_of<S1>::type{}, typename reads_of<S2>::type{})
+                                     || intersects(typename writes_of<S1>::type{}, typename writes_of<S2>::type{})
+                                     || intersects(typename reads_of<S1>::type{}, typename writes_of<S2>::type{});
+    }
+
     /// @brief Dispatcher class that allows dispatching events to multiple systems.
+    /// @details Systems handling an event run level by level: a system declaring the components it accesses
+    /// (see components) joins the level after the last earlier system it conflicts with, and the systems
+    /// of a level run concurrently if a thread pool with workers is given, one after another otherwise.
+    /// Each system waits for all the earlier systems it conflicts with, so the outcome is the same as
+    /// in declaration order, and the commands the systems record are applied in the same order
+    /// whatever the number of threads (see BasicCommandBuffer). Systems that don't declare their accesses
+    /// conflict with every other, and run alone on the calling thread, so they may create and remove entities
+    /// and components.
+    /// Declared systems record such changes in the command buffer of the context instead, see BasicContext::commands().
     /// @tparam Ss Variadic template parameter for systems.
     template<typename... Ss>
     class Dispatcher {
+        static constexpr size_t NO_LEVEL = std::numeric_limits<size_t>::max();
+
         std::tuple<Ss...> systems_;
 
     public:
@@ -14,23 +74,120 @@ namespace sim {
         /// @tparam Event The event to be dispatched.
         /// @param event The event to be dispatched.
         /// @param context The context in which the event is dispatched.
-        template<typename Event>
-        void dispatch_to_all(const Event& event, Context& context);
+        /// @param pool The thread pool running non-conflicting systems concurrently.
+        /// Without one, or if it has no workers, the systems of each level run one after another.
+        template<typename Event, typename Ctx>
+        void dispatch_to_all(const Event& event, Ctx& context, ThreadPool* pool = nullptr);
+
+        /// @brief Calls a callable for every component type declared as read or written by the systems.
+        /// @details Lets the simulation create their storages upfront, so concurrent systems never do.
+        /// Types declared by several systems are visited several times.
+        /// @param callable Called with a `std::type_identity<C>` for each component type C.
+        static void for_each_declared(auto&& callable);
+
+    private:
+        template<typename Event, typename Ctx, typename S>
+        static constexpr bool handles();
+
+        // Gets the level of every system for an event: the systems of a level run concurrently,
+        // after those of the previous levels. NO_LEVEL for systems not handling the event.
+        template<typename Event, typename Ctx>
+        static constexpr std::array<size_t, sizeof...(Ss)> schedule();
+
+        template<size_t I, typename Event, typename Ctx>
+        static void run_system(Dispatcher& dispatcher, const Event& event, Ctx& context);
     };
 
+    // Implementation ============================================================================
+
+    template<typename... Ss>
+    template<typename Event, typename Ctx>
+    void Dispatcher<Ss...>::dispatch_to_all(const Event& event, Ctx& context, ThreadPool* pool) {
+        // Without workers, the levels run their systems one after another, in the same loops as with workers,
+        // so the commands they record are ordered the same way regardless of the number of threads
+        static ThreadPool no_workers(0);
+        ThreadPool& runner = pool ? *pool : no_workers;
+
+        using runner_t = void (*)(Dispatcher&, const Event&, Ctx&);
+        static constexpr std::array<size_t, sizeof...(Ss)> levels = schedule<Event, Ctx>();
+        static constexpr std::array<runner_t, sizeof...(Ss)> runners = []<size_t... I>(std::index_sequence<I...>) {
+            return std::array<runner_t, sizeof...(Ss)>{&run_system<I, Event, Ctx>...};
+        }(std::index_sequence_for<Ss...>{});
+
+        static constexpr size_t depth = [] {
+            size_t deepest = 0;
+            for (const size_t level: levels)
+                if (level != NO_LEVEL)
+                    deepest = std::max(deepest, level + 1);
+            return deepest;
+        }();
+
+        for (size_t level = 0; level < depth; ++level) {
+            std::array<size_t, sizeof...(Ss)> batch{};
+            size_t count = 0;
+            for (size_t i = 0; i < levels.size(); ++i)
+                if (levels[i] == level)
+                    batch[count++] = i;
+
+            if (count == 1) // Undeclared systems are always alone, so they run on this thread
+                runners[batch[0]](*this, event, context);
+            else
+                runner.parallel_for(count, 1, 0, [&](const Chunk& chunk) {
+                    runners[batch[chunk.index]](*this, event, context);
+                });
+        }
+    }
+
+    template<typename... Ss>
+    void Dispatcher<Ss...>::for_each_declared(auto&& callable) {
+        const auto visit = [&]<typename... Cs>(components<Cs...>) {
+            (callable(std::type_identity<Cs>{}), ...);
+        };
+        (visit(typename detail::reads_of<Ss>::type{}), ...);
+        (visit(typename detail::writes_of<Ss>::type{}), ...);
+    }
+
+    template<typename... Ss>
+    template<typename Event, typename Ctx, typename S>
+    constexpr bool Dispatcher<Ss...>::handles() {
+        return requires(S& system, const Event& event, Ctx& context) { system(event); }
+               || requires(S& system, const Event& event, Ctx& context) { system(event, context); };
+    }
+
+    // A system joins the level after the last earlier system it conflicts with, so ties keep the declaration order
+    template<typename... Ss>
+    template<typename Event, typename Ctx>
+    constexpr std::array<size_t, sizeof...(Ss)> Dispatcher<Ss...>::schedule() {
+        constexpr size_t n = sizeof...(Ss);
+        constexpr std::array<bool, n> handling{handles<Event, Ctx, Ss>()...};
+        constexpr std::array<bool, n * n> conflicts = []<size_t... I>(std::index_sequence<I...>) {
+            using systems_t = std::tuple<Ss...>;
+            return std::array<bool, n * n>{
+                detail::conflicts_v<std::tuple_element_t<I / n, systems_t>, std::tuple_element_t<I % n, systems_t> >...
+            };
+        }(std::make_index_sequence<n * n>{});
+
+        std::array<size_t, n> levels{};
+        for (size_t j = 0; j < n; ++j) {
+            levels[j] = handling[j] ? 0 : NO_LEVEL;
+            if (!handling[j]) continue;
+            for (size_t i = 0; i < j; ++i)
+                if (handling[i] && conflicts[i * n + j])
+                    levels[j] = std::max(levels[j], levels[i] + 1);
+        }
+        return levels;
+    }
+
     template<typename... Ss>
-    template<typename Event>
-    void Dispatcher<Ss...>::dispatch_to_all(const Event& event, Context& context) {
-        std::apply([&](Ss&... system) {
-            ([&] {
-                if constexpr (requires { system(event); }) {
-                    system(event);
-                }
-                if constexpr (requires { system(event, context); }) {
-                    system(event, context);
-                }
-            }(), ...);
-        }, systems_);
+    template<size_t I, typename Event, typename Ctx>
+    void Dispatcher<Ss...>::run_system(Dispatcher& dispatcher, const Event& event, Ctx& context) {
+        auto& system = std::get<I>(dispatcher.systems_);
+        if constexpr (requires { system(event); }) {
+            system(event);
+        }
+        if constexpr (requires { system(event, context); }) {
+            system(event, context);
+        }
     }
 }
 #endif //SYSTEMS_H
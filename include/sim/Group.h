@@ -0,0 +1,224 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "Registry.h"
+
+namespace sim {
+    /// @brief An owning group, keeping the entities having all of its components packed in lockstep.
+    /// @details The members occupy the first size() dense slots of every owned storage, in the same order,
+    /// so iterating them is a plain index loop over contiguous arrays without any membership test.
+    /// Entities join and leave the group as their components are added and removed, by swapping
+    /// their slots to the boundary of the group. Created with Registry::group().
+    /// Components requested as const are only handed out read-only, so they are not marked as changed.
+    /// @tparam Reg The registry type managing the entities.
+    /// @tparam Cs The owned component types, const qualified to only read them.
+    template<typename Reg, typename... Cs>
+    class BasicGroup final : public GroupBase {
+        std::tuple<Storage<std::remove_const_t<Cs> >*...> storages_;
+        Reg* registry_;
+        size_t size_ = 0; // Number of members, packed at the front of every owned storage
+
+    public:
+        /// @brief Constructs a group over the given storages and packs the entities already having all of them.
+        /// @param registry A pointer to the registry managing the entities.
+        /// @param storages The storages of the owned components.
+        explicit BasicGroup(Reg* registry, Storage<std::remove_const_t<Cs> >*... storages);
+
+        /// @brief Get the number of entities in the group.
+        /// @return The number of members.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Checks if the group is empty.
+        /// @return Whether the group has no members.
+        [[nodiscard]] bool empty() const;
+
+        /// @brief Checks if an entity is a member of the group.
+        /// @param entity_id The ID of the entity.
+        /// @return Whether the entity has all the owned components.
+        [[nodiscard]] bool contains(id_t entity_id) const;
+
+        /// @brief Get the IDs of the members, in the order of the owned storages.
+        /// @return A span over the member IDs.
+        [[nodiscard]] std::span<const id_t> entities() const;
+
+        /// @brief Calls the given callable for each member of the group.
+        /// @details The callable should accept all the owned components as references to const.
+        /// It can also optionally accept the entity itself as the first argument.
+        /// @param callable The callable to call for each member.
+        void for_each(auto&& callable) const;
+
+        /// @brief Calls the given callable for each member of the group.
+        /// @details The callable should accept all the owned components as arguments, and can modify those
+        /// not requested as const.
+        /// It can also optionally accept the entity itself as the first argument.
+        /// Members are visited from the back, so the current one may leave the group during the iteration.
+        /// Entities joining the group during the iteration are not visited.
+        /// @param callable The callable to call for each member.
+        void for_each(auto&& callable);
+
+        /// @brief Calls the given callable for contiguous runs of members, the whole group unless split.
+        /// @details The callable should accept a span of const components per owned component type,
+        /// and can optionally accept the span of entity IDs first.
+        /// The callable must not add or remove components of the owned types.
+        /// @param callable The callable to call for each run.
+        /// @param max_size The maximal number of members per run, e.g. to split the work into tasks.
+        void each_chunk(auto&& callable, size_t max_size = std::numeric_limits<size_t>::max()) const;
+
+        /// @brief Calls the given callable for contiguous runs of members, the whole group unless split.
+        /// @details Like the const overload, but the callable receives mutable spans of the components
+        /// not requested as const.
+        /// @param callable The callable to call for each run.
+        /// @param max_size The maximal number of members per run, e.g. to split the work into tasks.
+        void each_chunk(auto&& callable, size_t max_size = std::numeric_limits<size_t>::max());
+
+        void on_construct(id_t entity_id) override;
+
+        void on_destroy(id_t entity_id) override;
+
+        void rebuild() override;
+
+    private:
+        // Gets an owned storage, read-only for const iterations and components requested as const
+        template<bool Const, size_t I>
+        [[nodiscard]] auto& storage() const;
+
+        template<bool Const>
+        void for_each_impl(auto&& callable) const;
+
+        template<bool Const>
+        void each_chunk_impl(auto&& callable, size_t max_size) const;
+
+        // Swaps the components of an entity to a dense index in every owned storage
+        void move_to(id_t entity_id, size_t index);
+    };
+
+    // Implementation ============================================================================
+
+    template<typename Reg, typename... Cs>
+    BasicGroup<Reg, Cs...>::BasicGroup(Reg* registry, Storage<std::remove_const_t<Cs> >*... storages):
+        GroupBase([] {
+            Signature owned;
+            (owned.set(Reg::template component_id<Cs>()), ...);
+            return owned;
+        }()), storages_(storages...), registry_(registry) {
+        rebuild();
+    }
+
+    template<typename Reg, typename... Cs>
+    size_t BasicGroup<Reg, Cs...>::size() const {
+        return size_;
+    }
+
+    template<typename Reg, typename... Cs>
+    bool BasicGroup<Reg, Cs...>::empty() const {
+        return size_ == 0;
+    }
+
+    template<typename Reg, typename... Cs>
+    bool BasicGroup<Reg, Cs...>::contains(const id_t entity_id) const {
+        const auto* storage = std::get<0>(storages_);
+        return storage->entity_has(entity_id) && storage->index_of(entity_id) < size_;
+    }
+
+    template<typename Reg, typename... Cs>
+    std::span<const id_t> BasicGroup<Reg, Cs...>::entities() const {
+        return std::span(std::get<0>(storages_)->entities()).first(size_);
+    }
+
+    template<typename Reg, typename... Cs>
+    template<bool Const, size_t I>
+    auto& BasicGroup<Reg, Cs...>::storage() const {
+        if constexpr (Const || std::is_const_v<std::tuple_element_t<I, std::tuple<Cs...> > >)
+            return std::as_const(*std::get<I>(storages_));
+        else
+            return *std::get<I>(storages_);
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::for_each(auto&& callable) const {
+        for_each_impl<true>(std::forward<decltype(callable)>(callable));
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::for_each(auto&& callable) {
+        for_each_impl<false>(std::forward<decltype(callable)>(callable));
+    }
+
+    // A member leaving the group swaps places with the last one, which was already visited
+    template<typename Reg, typename... Cs>
+    template<bool Const>
+    void BasicGroup<Reg, Cs...>::for_each_impl(auto&& callable) const {
+        using entity_t = std::conditional_t<Const, typename Reg::const_entity_type, typename Reg::entity_type>;
+
+        for (size_t pos = size_; pos-- > 0;) {
+            entity_t entity(std::get<0>(storages_)->entities()[pos], registry_);
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                if constexpr (requires { callable(entity, storage<Const, I>().at(pos)...); })
+                    callable(entity, storage<Const, I>().at(pos)...);
+                else
+                    callable(storage<Const, I>().at(pos)...);
+            }(std::index_sequence_for<Cs...>{});
+        }
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::each_chunk(auto&& callable, const size_t max_size) const {
+        each_chunk_impl<true>(std::forward<decltype(callable)>(callable), max_size);
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::each_chunk(auto&& callable, const size_t max_size) {
+        each_chunk_impl<false>(std::forward<decltype(callable)>(callable), max_size);
+    }
+
+    template<typename Reg, typename... Cs>
+    template<bool Const>
+    void BasicGroup<Reg, Cs...>::each_chunk_impl(auto&& callable, const size_t max_size) const {
+        static_assert((is_dense_v<std::remove_const_t<Cs> > && ...), "Chunks need all components stored in a DensePool");
+
+        for (size_t first = 0, length = 0; first < size_; first += length) {
+            length = std::min(max_size, size_ - first);
+            const std::span<const id_t> ids = entities().subspan(first, length);
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                if constexpr (requires { callable(ids, storage<Const, I>().span(first, length)...); })
+                    callable(ids, storage<Const, I>().span(first, length)...);
+                else
+                    callable(storage<Const, I>().span(first, length)...);
+            }(std::index_sequence_for<Cs...>{});
+        }
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::on_construct(const id_t entity_id) {
+        if (contains(entity_id) || !registry_->signatures_[to_index(entity_id)].contains(owned()))
+            return;
+        move_to(entity_id, size_++);
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::on_destroy(const id_t entity_id) {
+        if (!contains(entity_id)) return;
+        move_to(entity_id, --size_);
+    }
+
+    // Walks the first storage in order, so members keep their relative order
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::rebuild() {
+        size_ = 0;
+        const std::vector<id_t>& entities = std::get<0>(storages_)->entities();
+        for (size_t pos = 0; pos < entities.size(); ++pos) {
+            const id_t entity_id = entities[pos];
+            if (entity_id != NO_ID && registry_->signatures_[to_index(entity_id)].contains(owned()))
+                move_to(entity_id, size_++);
+        }
+    }
+
+    template<typename Reg, typename... Cs>
+    void BasicGroup<Reg, Cs...>::move_to(const id_t entity_id, const size_t index) {
+        std::apply([&](auto*... storage) {
+            (storage->swap_slots(storage->index_of(entity_id), index), ...);
+        }, storages_);
+    }
+}
+
+#endif //GROUP_H
@@ -0,0 +1,108 @@
+#ifndef IDALLOCATOR_H
+#define IDALLOCATOR_H
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "Types.h"
+
+namespace sim {
+    /// @brief Allocates entity IDs and recycles the indices of released ones.
+    /// @details Released indices are kept on a free list and handed out again with a bumped generation,
+    /// so handles to the previous owner of the index become stale instead of aliasing the new entity.
+    class IdAllocator {
+        std::vector<id_t> slots_; // Current ID (with generation) for each index
+        std::vector<id_t> free_; // Released indices, reused in LIFO order
+
+    public:
+        /// @brief Default constructor.
+        explicit IdAllocator() = default;
+
+        /// @brief Allocates a new entity ID, reusing a released index if there is one.
+        /// @throws std::length_error if the entity index space is exhausted.
+        /// @return The new entity ID.
+        [[nodiscard]] id_t create();
+
+        /// @brief Allocates a number of entity IDs at once, reusing released indices first.
+        /// @throws std::length_error if the entity index space would be exhausted. No IDs are allocated then.
+        /// @param n The number of IDs to allocate.
+        /// @param out The vector to append the new IDs to.
+        void create_many(size_t n, std::vector<id_t>& out);
+
+        /// @brief Releases an entity ID, making its index available for reuse.
+        /// Releasing a stale or unknown ID does nothing.
+        /// @param id The ID to release.
+        /// @return Whether the ID was alive and got released.
+        bool release(id_t id);
+
+        /// @brief Checks if an entity ID is alive, i.e. allocated and not yet released.
+        /// @param id The ID to check.
+        /// @return Whether the ID is alive.
+        [[nodiscard]] bool alive(id_t id) const;
+
+        /// @brief Get the number of alive entities.
+        /// @return The number of alive entities.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Get the number of indices ever handed out, alive or released.
+        /// @return The size of the index space in use.
+        [[nodiscard]] size_t capacity() const;
+    };
+
+    // Implementation ============================================================================
+
+    inline id_t IdAllocator::create() {
+        if (!free_.empty()) {
+            const id_t index = free_.back();
+            free_.pop_back();
+            return slots_[index] = make_id(index, to_generation(slots_[index]));
+        }
+
+        if (slots_.size() >= MAX_ENTITIES)
+            throw std::length_error("Entity limit reached");
+        const id_t id = make_id(slots_.size(), 0);
+        slots_.push_back(id);
+        return id;
+    }
+
+    inline void IdAllocator::create_many(size_t n, std::vector<id_t>& out) {
+        const size_t recycled = std::min(n, free_.size());
+        if (slots_.size() + (n - recycled) > MAX_ENTITIES)
+            throw std::length_error("Entity limit reached");
+
+        out.reserve(out.size() + n);
+        for (size_t i = 0; i < recycled; ++i)
+            out.push_back(create());
+        n -= recycled;
+
+        const id_t first = slots_.size();
+        slots_.reserve(slots_.size() + n);
+        for (id_t index = first; index < first + n; ++index)
+            slots_.push_back(make_id(index, 0));
+        out.insert(out.end(), slots_.begin() + first, slots_.end());
+    }
+
+    inline bool IdAllocator::release(const id_t id) {
+        if (!alive(id)) return false;
+        const id_t index = to_index(id);
+        // Bump the generation (wrapping around) and mark the slot as free by pointing it to NO_ID's index
+        slots_[index] = make_id(ENTITY_INDEX_MASK, to_generation(id) + 1);
+        free_.push_back(index);
+        return true;
+    }
+
+    inline bool IdAllocator::alive(const id_t id) const {
+        const id_t index = to_index(id);
+        return index < slots_.size() && slots_[index] == id;
+    }
+
+    inline size_t IdAllocator::size() const {
+        return slots_.size() - free_.size();
+    }
+
+    inline size_t IdAllocator::capacity() const {
+        return slots_.size();
+    }
+}
+
+#endif //IDALLOCATOR_H
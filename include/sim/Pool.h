@@ -0,0 +1,532 @@
+#ifndef POOL_H
+#define POOL_H
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Traits.h"
+
+namespace sim {
+    /// @brief Default component pool, keeping components contiguously in a vector.
+    /// @details A pool holds the component payload of a Storage in dense order,
+    /// while the Storage itself keeps the mapping between entities and dense indices.
+    /// @tparam T The component type.
+    template<typename T>
+    class DensePool {
+        std::vector<T> data_;
+
+    public:
+        /// @brief Get the number of components in the pool.
+        /// @return The number of components.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Reserve space for a number of components.
+        /// @param n The number of components to reserve space for.
+        void reserve(size_t n);
+
+        /// @brief Access the component at a dense index.
+        /// @param index The dense index.
+        /// @return A reference to the component.
+        [[nodiscard]] auto&& operator[](this auto&& self, size_t index);
+
+        /// @brief Access the contiguous array of components.
+        /// @return A pointer to the first component.
+        [[nodiscard]] auto* data(this auto&& self);
+
+        /// @brief Construct a component at the end of the pool.
+        /// @param args The arguments to forward to the component constructor.
+        template<typename... Args>
+        void emplace_back(Args&&... args);
+
+        /// @brief Swap the components at two dense indices.
+        void swap(size_t a, size_t b);
+
+        /// @brief Remove the last component.
+        void pop_back();
+    };
+
+    /// @brief Pool for empty (tag) components that stores nothing.
+    /// @details All accesses return one shared instance, so only the entity mapping of the Storage costs memory.
+    /// @tparam T The empty component type.
+    template<typename T>
+    class EmptyPool {
+        static_assert(std::is_empty_v<T>, "EmptyPool can only hold empty types");
+
+        inline static T instance_{};
+        size_t size_ = 0;
+
+    public:
+        /// @brief Get the number of components in the pool.
+        /// @return The number of components.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Does nothing, as nothing is stored.
+        void reserve(size_t);
+
+        /// @brief Access the shared instance.
+        /// @return A reference to the shared instance.
+        [[nodiscard]] auto&& operator[](this auto&& self, size_t);
+
+        /// @brief Count a new component. The arguments are still used to construct (and discard) an instance.
+        /// @param args The arguments to forward to the component constructor.
+        template<typename... Args>
+        void emplace_back(Args&&... args);
+
+        /// @brief Does nothing, as all instances are the same.
+        void swap(size_t, size_t);
+
+        /// @brief Remove the last component.
+        void pop_back();
+    };
+
+    /// @brief Pointer-stable pool, keeping components in fixed-size chunks that are never reallocated.
+    /// @details Components are never moved: removed ones leave a free slot that is reused by later insertions,
+    /// threaded through the freed slots themselves as a free list. References and pointers to a component thus
+    /// stay valid until the component is removed, even across compaction, which does nothing for such storages.
+    /// Opt in by specializing storage_policy, e.g.
+    /// `template<> struct sim::storage_policy<Transform> { using type = StablePool<Transform>; };`.
+    /// Storages using it can't be sorted.
+    /// @tparam T The component type.
+    /// @tparam ChunkSize The number of components per chunk.
+    template<typename T, size_t ChunkSize = 1024>
+    class StablePool {
+        static_assert(ChunkSize > 0, "StablePool needs a positive chunk size");
+        static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
+        union Slot {
+            T value;
+            size_t next_free;
+
+            Slot() : next_free(NO_SLOT) {}
+            ~Slot() {}
+        };
+
+        std::vector<std::unique_ptr<Slot[]> > chunks_;
+        std::vector<bool> used_; // Whether each slot holds a component
+        size_t free_ = NO_SLOT; // Head of the free list
+
+    public:
+        StablePool() = default;
+        StablePool(const StablePool&) = delete;
+        StablePool(StablePool&&) = default;
+        StablePool& operator=(const StablePool&) = delete;
+        StablePool& operator=(StablePool&&) = default;
+        ~StablePool();
+
+        /// @brief Get the number of slots in the pool, including free ones.
+        /// @return The number of slots.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Allocate chunks for a number of slots.
+        /// @param n The number of slots to allocate.
+        void reserve(size_t n);
+
+        /// @brief Access the component at a slot.
+        /// @param index The slot index, which must hold a component.
+        /// @return A reference to the component.
+        [[nodiscard]] auto&& operator[](this auto&& self, size_t index);
+
+        /// @brief Construct a component in the most recently freed slot, or in a new one at the end.
+        /// @param args The arguments to forward to the component constructor.
+        /// @return The slot index of the component.
+        template<typename... Args>
+        size_t emplace(Args&&... args);
+
+        /// @brief Destroy the component at a slot and free the slot for reuse.
+        /// @param index The slot index, which must hold a component.
+        void erase(size_t index);
+
+    private:
+        [[nodiscard]] Slot& slot(size_t index);
+    };
+
+    template<bool Const, typename T, auto... Members>
+    class SoaRef;
+
+    /// @brief Structure-of-arrays pool, keeping one contiguous column per listed data member.
+    /// @details Opt in by specializing storage_policy for an aggregate component, e.g.
+    /// `template<> struct sim::storage_policy<Position> { using type = SoaPool<Position, &Position::x, &Position::y>; };`.
+    /// Single members are accessed through columns, so tight loops over them can be vectorized.
+    /// Elements are accessed through SoaRef proxies instead of plain references,
+    /// so systems need to take such components by `auto` (or `auto&&`) instead of `T&`.
+    /// @tparam T The component type. It must be default constructible.
+    /// @tparam Members Pointers to all the data members of T to store, each in its own column.
+    template<typename T, auto... Members>
+    class SoaPool {
+        static_assert(sizeof...(Members) > 0, "SoaPool needs at least one member");
+        static_assert((std::same_as<typename member_pointer_traits<decltype(Members)>::class_t, T> && ...),
+                      "All members must belong to the component type");
+
+        std::tuple<std::vector<member_value_t<Members> >...> columns_;
+
+        template<bool, typename, auto...>
+        friend class SoaRef;
+
+    public:
+        /// @brief Get the number of components in the pool.
+        /// @return The number of components.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Reserve space for a number of components in every column.
+        /// @param n The number of components to reserve space for.
+        void reserve(size_t n);
+
+        /// @brief Access the component at a dense index.
+        /// @param index The dense index.
+        /// @return A proxy referring to the component's members.
+        [[nodiscard]] SoaRef<false, T, Members...> operator[](size_t index);
+
+        /// @brief Access the component at a dense index.
+        /// @param index The dense index.
+        /// @return A proxy referring to the component's members.
+        [[nodiscard]] SoaRef<true, T, Members...> operator[](size_t index) const;
+
+        /// @brief Construct a component and scatter its members to the end of the columns.
+        /// @param args The arguments to forward to the component constructor.
+        template<typename... Args>
+        void emplace_back(Args&&... args);
+
+        /// @brief Swap the components at two dense indices.
+        void swap(size_t a, size_t b);
+
+        /// @brief Remove the last component.
+        void pop_back();
+
+        /// @brief Get the column of one member.
+        /// @tparam Member Pointer to the data member, one of Members.
+        /// @return A span over the member values of all components, in dense order.
+        template<auto Member>
+        [[nodiscard]] auto column(this auto&& self);
+
+    private:
+        template<auto Member>
+        static constexpr size_t column_index();
+    };
+
+    /// @brief Proxy referring to one component stored in a SoaPool.
+    /// @tparam Const Whether the proxy gives read-only access.
+    /// @tparam T The component type.
+    /// @tparam Members The members stored by the pool.
+    template<bool Const, typename T, auto... Members>
+    class SoaRef {
+        using pool_t = std::conditional_t<Const, const SoaPool<T, Members...>, SoaPool<T, Members...> >;
+
+        pool_t* pool_;
+        size_t index_;
+
+        template<bool, typename, auto...>
+        friend class SoaRef;
+
+    public:
+        /// @brief Constructs a proxy for a dense index of a pool.
+        SoaRef(pool_t* pool, size_t index);
+
+        /// @brief Converts a mutable proxy to a read-only one.
+        template<bool OtherConst> requires (Const && !OtherConst)
+        SoaRef(const SoaRef<OtherConst, T, Members...>& other); // NOLINT
+
+        /// @brief Gathers the members into a component value.
+        [[nodiscard]] operator T() const; // NOLINT
+
+        /// @brief Scatters a component value into the columns.
+        /// @param value The value to store.
+        /// @return A reference to this proxy.
+        const SoaRef& operator=(const T& value) const requires (!Const);
+
+        /// @brief Gets a reference to one member of the component.
+        /// @tparam Member Pointer to the data member, one of Members.
+        /// @return A reference to the member value.
+        template<auto Member>
+        [[nodiscard]] auto& get() const;
+    };
+
+    /// @brief Customization point selecting the pool used to store components of type T.
+    /// @details Specialize this for a component type to change its storage layout.
+    /// Empty types use EmptyPool by default, everything else uses DensePool.
+    /// @tparam T The component type.
+    template<typename T>
+    struct storage_policy {
+        /// @brief The pool type.
+        using type = std::conditional_t<std::is_empty_v<T>, EmptyPool<T>, DensePool<T> >;
+    };
+
+    /// @brief The pool type used to store components of type T.
+    template<typename T>
+    using pool_t = typename storage_policy<T>::type;
+
+    /// @brief Customization point enabling change detection for components of type T.
+    /// @details Tracked storages record the tick at which each component was added and last accessed mutably,
+    /// and the entities whose component was removed, for the added, changed filters of views
+    /// and Registry::removed(). Opt in by specializing it, e.g.
+    /// `template<> struct sim::track_changes<Transform> : std::true_type {};`.
+    /// @tparam T The component type.
+    template<typename T>
+    struct track_changes : std::false_type {};
+
+    /// @brief Whether changes to components of type T are tracked.
+    template<typename T>
+    constexpr bool is_tracked_v = track_changes<T>::value;
+
+    /// @brief The type through which a stored component of type T is accessed, usually T&.
+    template<typename T>
+    using reference_t = decltype(std::declval<pool_t<T>&>()[0]);
+
+    /// @brief The type through which a stored component of type T is read, usually const T&.
+    template<typename T>
+    using const_reference_t = decltype(std::declval<const pool_t<T>&>()[0]);
+
+    template<typename Pool>
+    struct is_soa_pool : std::false_type {};
+
+    template<typename T, auto... Members>
+    struct is_soa_pool<SoaPool<T, Members...> > : std::true_type {};
+
+    /// @brief Whether components of type T are stored in a SoaPool.
+    template<typename T>
+    constexpr bool is_soa_v = is_soa_pool<pool_t<T> >::value;
+
+    template<typename Pool>
+    struct is_stable_pool : std::false_type {};
+
+    template<typename T, size_t ChunkSize>
+    struct is_stable_pool<StablePool<T, ChunkSize> > : std::true_type {};
+
+    /// @brief Whether components of type T are stored in a pointer-stable StablePool.
+    template<typename T>
+    constexpr bool is_stable_v = is_stable_pool<pool_t<T> >::value;
+
+    /// @brief Whether components of type T are stored contiguously in a DensePool.
+    template<typename T>
+    constexpr bool is_dense_v = std::is_same_v<pool_t<T>, DensePool<T> >;
+
+    namespace detail {
+        /// @brief Reorders a sequence in place by following the cycles of a permutation.
+        /// @param order For each new position, the old position of the element to move there. Left as identity.
+        /// @param swap Called to swap the elements at two positions.
+        void permute(std::span<size_t> order, auto&& swap);
+    }
+
+    // Implementation ============================================================================
+
+    template<typename T>
+    size_t DensePool<T>::size() const {
+        return data_.size();
+    }
+
+    template<typename T>
+    void DensePool<T>::reserve(const size_t n) {
+        data_.reserve(n);
+    }
+
+    template<typename T>
+    auto&& DensePool<T>::operator[](this auto&& self, const size_t index) {
+        return self.data_[index];
+    }
+
+    template<typename T>
+    auto* DensePool<T>::data(this auto&& self) {
+        return self.data_.data();
+    }
+
+    template<typename T>
+    template<typename... Args>
+    void DensePool<T>::emplace_back(Args&&... args) {
+        data_.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    void DensePool<T>::swap(const size_t a, const size_t b) {
+        std::swap(data_[a], data_[b]);
+    }
+
+    template<typename T>
+    void DensePool<T>::pop_back() {
+        data_.pop_back();
+    }
+
+    template<typename T, auto... Members>
+    size_t SoaPool<T, Members...>::size() const {
+        return std::get<0>(columns_).size();
+    }
+
+    template<typename T, auto... Members>
+    void SoaPool<T, Members...>::reserve(const size_t n) {
+        std::apply([n](auto&... column) { (column.reserve(n), ...); }, columns_);
+    }
+
+    template<typename T, auto... Members>
+    SoaRef<false, T, Members...> SoaPool<T, Members...>::operator[](const size_t index) {
+        return {this, index};
+    }
+
+    template<typename T, auto... Members>
+    SoaRef<true, T, Members...> SoaPool<T, Members...>::operator[](const size_t index) const {
+        return {this, index};
+    }
+
+    template<typename T, auto... Members>
+    template<typename... Args>
+    void SoaPool<T, Members...>::emplace_back(Args&&... args) {
+        T value(std::forward<Args>(args)...);
+        (std::get<column_index<Members>()>(columns_).push_back(std::move(value.*Members)), ...);
+    }
+
+    template<typename T, auto... Members>
+    void SoaPool<T, Members...>::swap(const size_t a, const size_t b) {
+        std::apply([a, b](auto&... column) { (std::swap(column[a], column[b]), ...); }, columns_);
+    }
+
+    template<typename T, auto... Members>
+    void SoaPool<T, Members...>::pop_back() {
+        std::apply([](auto&... column) { (column.pop_back(), ...); }, columns_);
+    }
+
+    template<typename T, auto... Members>
+    template<auto Member>
+    auto SoaPool<T, Members...>::column(this auto&& self) {
+        return std::span(std::get<column_index<Member>()>(self.columns_));
+    }
+
+    template<typename T, auto... Members>
+    template<auto Member>
+    constexpr size_t SoaPool<T, Members...>::column_index() {
+        constexpr std::array matches{is_same_member_v<Member, Members>...};
+        constexpr size_t index = std::ranges::find(matches, true) - matches.begin();
+        static_assert(index < sizeof...(Members), "Member is not stored in this pool");
+        return index;
+    }
+
+    template<bool Const, typename T, auto... Members>
+    SoaRef<Const, T, Members...>::SoaRef(pool_t* pool, const size_t index): pool_(pool), index_(index) {}
+
+    template<bool Const, typename T, auto... Members>
+    template<bool OtherConst> requires (Const && !OtherConst)
+    SoaRef<Const, T, Members...>::SoaRef(const SoaRef<OtherConst, T, Members...>& other):
+        pool_(other.pool_), index_(other.index_) {}
+
+    template<bool Const, typename T, auto... Members>
+    SoaRef<Const, T, Members...>::operator T() const {
+        T value{};
+        ((value.*Members = get<Members>()), ...);
+        return value;
+    }
+
+    template<bool Const, typename T, auto... Members>
+    const SoaRef<Const, T, Members...>& SoaRef<Const, T, Members...>::operator=(const T& value) const requires (!Const) {
+        ((get<Members>() = value.*Members), ...);
+        return *this;
+    }
+
+    template<bool Const, typename T, auto... Members>
+    template<auto Member>
+    auto& SoaRef<Const, T, Members...>::get() const {
+        return pool_->template column<Member>()[index_];
+    }
+
+    template<typename T>
+    size_t EmptyPool<T>::size() const {
+        return size_;
+    }
+
+    template<typename T>
+    void EmptyPool<T>::reserve(size_t) {}
+
+    template<typename T>
+    auto&& EmptyPool<T>::operator[](this auto&& self, size_t) {
+        using instance_t = std::conditional_t<std::is_const_v<std::remove_reference_t<decltype(self)> >, const T&, T&>;
+        return static_cast<instance_t>(instance_);
+    }
+
+    template<typename T>
+    template<typename... Args>
+    void EmptyPool<T>::emplace_back(Args&&... args) {
+        [[maybe_unused]] T discarded(std::forward<Args>(args)...);
+        ++size_;
+    }
+
+    template<typename T>
+    void EmptyPool<T>::swap(size_t, size_t) {}
+
+    template<typename T>
+    void EmptyPool<T>::pop_back() {
+        --size_;
+    }
+
+    template<typename T, size_t ChunkSize>
+    StablePool<T, ChunkSize>::~StablePool() {
+        for (size_t index = 0; index < used_.size(); ++index)
+            if (used_[index])
+                std::destroy_at(&slot(index).value);
+    }
+
+    template<typename T, size_t ChunkSize>
+    size_t StablePool<T, ChunkSize>::size() const {
+        return used_.size();
+    }
+
+    template<typename T, size_t ChunkSize>
+    void StablePool<T, ChunkSize>::reserve(const size_t n) {
+        while (chunks_.size() * ChunkSize < n)
+            chunks_.push_back(std::make_unique<Slot[]>(ChunkSize));
+        used_.reserve(n);
+    }
+
+    template<typename T, size_t ChunkSize>
+    auto&& StablePool<T, ChunkSize>::operator[](this auto&& self, const size_t index) {
+        return self.chunks_[index / ChunkSize][index % ChunkSize].value;
+    }
+
+    template<typename T, size_t ChunkSize>
+    template<typename... Args>
+    size_t StablePool<T, ChunkSize>::emplace(Args&&... args) {
+        if (free_ != NO_SLOT) {
+            const size_t index = free_;
+            const size_t next = slot(index).next_free;
+            std::construct_at(&slot(index).value, std::forward<Args>(args)...);
+            free_ = next;
+            used_[index] = true;
+            return index;
+        }
+
+        const size_t index = used_.size();
+        if (index == chunks_.size() * ChunkSize)
+            chunks_.push_back(std::make_unique<Slot[]>(ChunkSize));
+        std::construct_at(&slot(index).value, std::forward<Args>(args)...);
+        used_.push_back(true);
+        return index;
+    }
+
+    template<typename T, size_t ChunkSize>
+    void StablePool<T, ChunkSize>::erase(const size_t index) {
+        std::destroy_at(&slot(index).value);
+        slot(index).next_free = free_;
+        free_ = index;
+        used_[index] = false;
+    }
+
+    template<typename T, size_t ChunkSize>
+    typename StablePool<T, ChunkSize>::Slot& StablePool<T, ChunkSize>::slot(const size_t index) {
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    void detail::permute(const std::span<size_t> order, auto&& swap) {
+        for (size_t i = 0; i < order.size(); ++i) {
+            size_t current = i;
+            while (order[current] != i) {
+                const size_t next = order[current];
+                swap(current, next);
+                order[current] = current;
+                current = next;
+            }
+            order[current] = current;
+        }
+    }
+}
+
+#endif //POOL_H
@@ -1,5 +1,12 @@
 #ifndef REGISTRY_H
 #define REGISTRY_H
+#include <atomic>
+#include <chrono>
+#include <source_location>
+#include <string_view>
+
+#include "IdAllocator.h"
+#include "Signature.h"
 #include "Storage.h"
 
 namespace sim {
@@ -7,18 +14,165 @@ namespace sim {
     using component_id_t = size_t;
 
     inline component_id_t generate_component_id() {
-        static component_id_t id = 0;
-        return id++;
+        static std::atomic<component_id_t> id = 0; // Parallel systems may use a component type first
+        return id.fetch_add(1, std::memory_order_relaxed);
     }
 
+    /// @brief Gets the ID of a component type in dynamic registries, assigned on first use.
+    /// @details IDs are dense, but depend on the order in which component types are first used.
+    /// For a deterministic ID see type_hash(), and for IDs fixed at compile time BasicRegistry.
+    /// @tparam C The component type. A const qualified type has the same ID as the unqualified one.
+    /// @return The ID of the component type.
     template<typename C>
     component_id_t get_component_id() {
-        static component_id_t id = generate_component_id();
-        return id;
+        if constexpr (std::is_const_v<C>) {
+            return get_component_id<std::remove_const_t<C> >();
+        } else {
+            static const component_id_t id = generate_component_id();
+            return id;
+        }
+    }
+
+    /// @brief Gets a stable hash of a type, computed at compile time from its name (FNV-1a).
+    /// @details Unlike component IDs it is the same in every translation unit and every run,
+    /// e.g. to identify component types in saved or networked state. It only depends on the compiler.
+    /// @tparam C The type.
+    /// @return The hash of the type name.
+    template<typename C>
+    consteval uint64_t type_hash() {
+        const std::string_view name = std::source_location::current().function_name();
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char c: name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // The standard doesn't require function names to spell out the template arguments
+    static_assert(type_hash<int>() != type_hash<float>(), "type_hash() can't tell types apart with this compiler");
+
+    /// @brief View filter skipping entities that have any of the given components.
+    /// @tparam Es The excluded component types.
+    template<typename... Es>
+    struct exclude_t {};
+
+    /// @brief View filter skipping entities that have any of the given components,
+    /// e.g. `view<Transform>(exclude<Movable>)`.
+    template<typename... Es>
+    inline constexpr exclude_t<Es...> exclude{};
+
+    /// @brief View filter adding components that entities may or may not have.
+    /// @details View::for_each passes a pointer for each of them after the required components, null if missing.
+    /// @tparam Os The optional component types.
+    template<typename... Os>
+    struct optional_t {
+        static_assert((!is_soa_v<Os> && ...), "Optional components can't be stored in a SoaPool");
+    };
+
+    /// @brief View filter adding components that entities may or may not have,
+    /// e.g. `view<Transform>(optional<Sprite>)`.
+    template<typename... Os>
+    inline constexpr optional_t<Os...> optional{};
+
+    /// @brief View filter keeping entities whose given components were all added since the previous tick.
+    /// @tparam Cs The component types, whose changes must be tracked, see track_changes.
+    template<typename... Cs>
+    struct added_t {
+        static_assert((is_tracked_v<Cs> && ...), "Filtered components must opt in to change tracking");
+    };
+
+    /// @brief View filter keeping entities whose given components were all added since the previous tick,
+    /// e.g. `view<Transform>(added<Transform>)`.
+    template<typename... Cs>
+    inline constexpr added_t<Cs...> added{};
+
+    /// @brief View filter keeping entities whose given components were all added or accessed mutably
+    /// since the previous tick.
+    /// @tparam Cs The component types, whose changes must be tracked, see track_changes.
+    template<typename... Cs>
+    struct changed_t {
+        static_assert((is_tracked_v<Cs> && ...), "Filtered components must opt in to change tracking");
+    };
+
+    /// @brief View filter keeping entities whose given components were all added or accessed mutably
+    /// since the previous tick, e.g. `view<Transform>(changed<Transform>)`.
+    /// @details The simulation advances the tick every cycle, so a system running once per cycle
+    /// sees every change at least once, possibly twice.
+    template<typename... Cs>
+    inline constexpr changed_t<Cs...> changed{};
+
+    /// @brief Whether a registry keeps the change ticks needed by added and changed view filters.
+    /// @tparam Reg The registry type.
+    template<typename Reg>
+    constexpr bool has_change_ticks_v = true;
+
+    namespace detail {
+        template<typename Reg, typename... Es>
+        void add_excluded(Signature& excluded, exclude_t<Es...>) {
+            // Component types beyond the signature width are left out, no entity can have them
+            const auto exclude = [&](const component_id_t id) { if (id < MAX_COMPONENTS) excluded.set(id); };
+            (exclude(Reg::template component_id<Es>()), ...);
+        }
+
+        template<typename Reg, typename... Os>
+        void add_excluded(Signature&, optional_t<Os...>) {}
+
+        template<typename Reg, typename... Cs>
+        void add_excluded(Signature&, added_t<Cs...>) {}
+
+        template<typename Reg, typename... Cs>
+        void add_excluded(Signature&, changed_t<Cs...>) {}
+
+        // Whether a view filter checks change ticks
+        template<typename F>
+        constexpr bool is_tick_filter_v = false;
+
+        template<typename... Cs>
+        constexpr bool is_tick_filter_v<added_t<Cs...> > = true;
+
+        template<typename... Cs>
+        constexpr bool is_tick_filter_v<changed_t<Cs...> > = true;
+
+        // The position of a type in a list of distinct types
+        template<typename T, typename... Ts>
+        constexpr size_t index_of_v = [] {
+            constexpr std::array<bool, sizeof...(Ts)> matches{std::is_same_v<T, Ts>...};
+            return static_cast<size_t>(std::ranges::find(matches, true) - matches.begin());
+        }();
+
+        // A change filter of a view, checking the storage of one component
+        struct TickFilter {
+            const StorageBase* storage; // Null if the storage doesn't exist, so nothing passes
+            bool added; // Whether to check the added tick rather than the changed one
+        };
+
+        // The optional filter among a list of view filters, the first one if there are more
+        template<typename... Fs>
+        struct optional_filter {
+            using type = optional_t<>;
+        };
+
+        template<typename F, typename... Fs>
+        struct optional_filter<F, Fs...> : optional_filter<Fs...> {};
+
+        template<typename... Os, typename... Fs>
+        struct optional_filter<optional_t<Os...>, Fs...> {
+            using type = optional_t<Os...>;
+        };
+
+        template<typename... Fs>
+        using optional_filter_t = typename optional_filter<Fs...>::type;
     }
 
     // Forward declarations and type aliases ================================================================
-    template<bool Const>
+    template<typename... Ks>
+    class BasicRegistry;
+
+    /// @brief The default, dynamic registry, accepting any component type.
+    using Registry = BasicRegistry<>;
+
+    template<bool Const, typename Reg = Registry>
     class EntityBase;
 
     /// @brief A mutable entity handle.
@@ -27,92 +181,371 @@ namespace sim {
     /// @brief An immutable entity handle.
     using ConstEntity = EntityBase<true>;
 
-    // Forward declaration (TODO)
-    template<bool Imm, typename... Cs>
-    class View;
+    template<typename Reg = Registry>
+    class BasicEntityBatch;
+
+    /// @brief A batch of entities of the default registry.
+    using EntityBatch = BasicEntityBatch<>;
+
+    template<typename Reg, bool Imm, typename Optional, typename... Cs>
+    class BasicView;
+
+    /// @brief A view over a set of components of the default registry.
+    /// @tparam Imm Whether the view is immutable (true) or mutable (false).
+    /// @tparam Optional The optional component types, see optional_t.
+    /// @tparam Cs Component types to include in the view.
+    template<bool Imm, typename Optional, typename... Cs>
+    using View = BasicView<Registry, Imm, Optional, Cs...>;
 
-    /// @brief An immutable view over a set of components.
+    /// @brief An immutable view over a set of components of the default registry.
     /// @tparam Cs Component types to include in the view.
     template<typename... Cs>
-    using ImmutableView = View<true, Cs...>;
+    using ImmutableView = BasicView<Registry, true, optional_t<>, Cs...>;
 
-    /// @brief A mutable view over a set of components.
+    /// @brief A mutable view over a set of components of the default registry.
     /// @tparam Cs Component types to include in the view.
     template<typename... Cs>
-    using MutableView = View<false, Cs...>;
+    using MutableView = BasicView<Registry, false, optional_t<>, Cs...>;
+
+    template<typename Reg, typename... Cs>
+    class BasicGroup;
+
+    /// @brief An owning group of components of the default registry.
+    /// @tparam Cs The owned component types.
+    template<typename... Cs>
+    using Group = BasicGroup<Registry, Cs...>;
 
     // ======================================================================================================
 
+    /// @brief Policy for the incremental compaction of storages, run once per simulation cycle.
+    /// @details Only storages whose share of tombstones (removed but not yet compacted components) exceeds
+    /// the ratio are compacted, and the work done per cycle is capped to keep frame times flat.
+    struct CompactionPolicy {
+        /// @brief Minimal share of tombstones in a storage for it to be compacted.
+        double min_tombstone_ratio = 0.05;
+
+        /// @brief Maximal number of tombstones removed per cycle over all storages. Zero means no limit.
+        size_t element_budget = 4096;
+
+        /// @brief Maximal time spent compacting per cycle. Zero means no limit.
+        std::chrono::microseconds time_budget{0};
+    };
+
+    /// @brief Base class of owning groups, notified by the registry whenever their members may change.
+    class GroupBase {
+        Signature owned_;
+
+    public:
+        /// @brief Constructs a group owning the storages of the given components.
+        explicit GroupBase(const Signature& owned);
+
+        virtual ~GroupBase() = default;
+
+        /// @brief Get the components whose storages the group owns.
+        /// @return The signature of the owned components.
+        [[nodiscard]] const Signature& owned() const;
+
+        /// @brief Called after an owned component was added to an entity.
+        /// @param entity_id The ID of the entity.
+        virtual void on_construct(id_t entity_id) = 0;
+
+        /// @brief Called before an owned component is removed from an entity.
+        /// @param entity_id The ID of the entity.
+        virtual void on_destroy(id_t entity_id) = 0;
+
+        /// @brief Packs the members again after the owned storages were reordered.
+        virtual void rebuild() = 0;
+    };
+
     /// @brief A registry that manages entities and their components.
-    class Registry {
-        std::vector<std::unique_ptr<StorageBase> > storages_;
+    /// @details Every component type is kept in its own sparse set storage.
+    /// Without a component list, the default Registry accepts any component type, assigning IDs on first use
+    /// and creating storages on demand. With a component list, only the listed types are accepted:
+    /// their IDs are their positions in the list, known at compile time, and the storages are held
+    /// in a tuple, so getting one is a plain member access.
+    /// @tparam Ks The component types, or none for a dynamic registry.
+    template<typename... Ks>
+    class BasicRegistry {
+        static_assert(sizeof...(Ks) <= MAX_COMPONENTS, "Too many component types, increase SIM_MAX_COMPONENTS");
+        static_assert([] {
+            size_t position = 0; // Every type is found at its own position, not at an earlier duplicate
+            return ((detail::index_of_v<Ks, Ks...> == position++) && ...);
+        }(), "Component types must be listed once");
+
+        static constexpr bool STATIC = sizeof...(Ks) > 0;
+        static constexpr size_t COMPACTION_SLICE = 256; // Tombstones removed between time budget checks
+
+        std::conditional_t<STATIC, std::tuple<Storage<Ks>...>, std::vector<std::unique_ptr<StorageBase> > > storages_;
+        std::vector<Signature> signatures_; // Components of each entity, indexed by entity index
+        std::vector<std::unique_ptr<GroupBase> > groups_;
+        std::vector<GroupBase*> owners_; // Group owning the storage of each component type, if any
+        IdAllocator ids_;
+        size_t compaction_cursor_ = 0; // Storage to continue incremental compaction from
+        tick_t tick_ = 0;
 
     public:
+        /// @brief The mutable entity handle type of this registry.
+        using entity_type = EntityBase<false, BasicRegistry>;
+
+        /// @brief The immutable entity handle type of this registry.
+        using const_entity_type = EntityBase<true, BasicRegistry>;
+
+        /// @brief Gets the ID of a component type, its bit in the signatures of entities.
+        /// @details With a component list, the position of the type in it, a compile-time constant.
+        /// Otherwise, see get_component_id().
+        /// @tparam C The component type. A const qualified type has the same ID as the unqualified one.
+        /// @return The ID of the component type.
+        template<typename C>
+        [[nodiscard]] static constexpr component_id_t component_id();
+
+        /// @brief Creates a new entity, recycling the index of a removed one if possible.
+        /// @throws std::length_error if the entity index space is exhausted.
+        /// @return A handle to the new entity.
+        entity_type create();
+
+        /// @brief Creates a number of entities at once, recycling indices of removed ones first.
+        /// @throws std::length_error if the entity index space would be exhausted.
+        /// @param n The number of entities to create.
+        /// @return A batch handle to the new entities.
+        BasicEntityBatch<BasicRegistry> create_many(size_t n);
+
+        /// @brief Checks if an entity is alive, i.e. created and not yet removed.
+        /// @param entity_id The ID of the entity to check.
+        /// @return Whether the entity is alive.
+        [[nodiscard]] bool alive(id_t entity_id) const;
+
+        /// @brief Gets the number of alive entities.
+        /// @return The number of alive entities.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Gets the current change tick, see track_changes.
+        /// @return The tick stamped on added and mutably accessed components of tracked types.
+        [[nodiscard]] tick_t tick() const;
+
+        /// @brief Advances the change tick, done by the simulation at the start of every cycle.
+        /// @details The added, changed filters of views and removed() report changes since the previous tick.
+        void advance_tick();
+
+        /// @brief Gets the entities whose component of a type was removed since the previous tick.
+        /// @tparam C The component type, whose changes must be tracked, see track_changes.
+        /// @return The IDs of the entities, in removal order. They may have been removed from the registry.
+        template<typename C>
+        [[nodiscard]] std::vector<id_t> removed() const;
+
         /// @brief Gets the storage for a specific component type.
+        /// @throws std::out_of_range if the storage wasn't created yet, only for dynamic registries.
         /// @tparam C The component type.
         /// @return A const reference to the storage for the component type.
         template<typename C>
         [[nodiscard]] const Storage<C>& get_storage() const;
 
-        /// @brief Gets the storage for a specific component type.
+        /// @brief Gets the storage for a specific component type, creating it on first use in dynamic registries.
+        /// @throws std::length_error if a dynamic registry has too many component types.
         /// @tparam C The component type.
         /// @return A mutable reference to the storage for the component type.
         template<typename C>
         [[nodiscard]] Storage<C>& get_storage();
 
+        /// @brief Checks if an alive entity has a specific component, in O(1) using its signature.
+        /// @tparam C The component type.
+        /// @param entity_id The ID of the entity.
+        /// @return Whether the entity is alive and has the component.
+        template<typename C>
+        [[nodiscard]] bool has(id_t entity_id) const;
+
+        /// @brief Gets a component of an entity.
+        /// @throws std::out_of_range if the entity doesn't have the component.
+        /// @tparam C The component type.
+        /// @param entity_id The ID of the entity.
+        /// @return A reference (or a reference proxy) to the component.
+        template<typename C>
+        [[nodiscard]] reference_t<C> get(id_t entity_id);
+
+        /// @brief Gets a component of an entity.
+        /// @throws std::out_of_range if the entity doesn't have the component.
+        /// @tparam C The component type.
+        /// @param entity_id The ID of the entity.
+        /// @return A const reference (or a reference proxy) to the component.
+        template<typename C>
+        [[nodiscard]] const_reference_t<C> get(id_t entity_id) const;
+
+        /// @brief Gets the signature of an entity, the set of component IDs it has.
+        /// @param entity_id The ID of the entity.
+        /// @return The signature of the entity, empty if the entity is not alive.
+        [[nodiscard]] Signature signature(id_t entity_id) const;
+
         /// @brief Pushes a component to an entity.
+        /// If the entity already has the component, its value is replaced.
+        /// @throws std::out_of_range if the entity is not alive.
         /// @tparam C The component type.
         /// @param entity The entity to which the component is added.
         /// @param component The component to add.
         template<typename C>
-        void push_back(ConstEntity entity, C&& component);
+        void push_back(const_entity_type entity, C&& component);
 
         /// @brief Emplaces a component to an entity.
+        /// If the entity already has the component, its value is replaced.
+        /// @throws std::out_of_range if the entity is not alive.
         /// @tparam Component The component type.
         /// @tparam Args The types of arguments to construct the component.
         /// @param entity The entity to which the component is added.
         /// @param args The arguments to construct the component.
         template<typename Component, typename... Args>
-        void emplace(ConstEntity entity, Args&&... args);
+        void emplace(const_entity_type entity, Args&&... args);
+
+        /// @brief Emplaces a component constructed from the same arguments to each of the given entities.
+        /// @throws std::out_of_range if any of the entities is not alive, before adding any component.
+        /// @tparam Component The component type.
+        /// @param entity_ids The IDs of the entities to which the component is added.
+        /// @param args The arguments passed to every component constructor.
+        template<typename Component, typename... Args>
+        void emplace_many(std::span<const id_t> entity_ids, const Args&... args);
 
-        /// @brief Removes all components from an entity.
+        /// @brief Pushes a range of components, one to each of the given entities.
+        /// @throws std::invalid_argument if the number of components doesn't match the number of IDs.
+        /// @throws std::out_of_range if any of the entities is not alive, before adding any component.
+        /// @tparam Component The component type.
+        /// @param entity_ids The IDs of the entities to which the components are added.
+        /// @param components The components to add, in the same order as the IDs, moved if the range owns them.
+        template<typename Component, std::ranges::sized_range R>
+        void insert(std::span<const id_t> entity_ids, R&& components);
+
+        /// @brief Pushes a component produced by a generator to each of the given entities.
+        /// @throws std::out_of_range if any of the entities is not alive, before adding any component.
+        /// @tparam Component The component type.
+        /// @param entity_ids The IDs of the entities to which the components are added.
+        /// @param generator Called in order of the IDs, either with no arguments or with the entity ID.
+        template<typename Component>
+        void generate(std::span<const id_t> entity_ids, auto&& generator);
+
+        /// @brief Removes all components from an entity and releases its ID for reuse.
+        /// Only the storages recorded in the entity's signature are visited.
+        /// Removing an entity that is not alive does nothing.
         /// @param entity The entity from which components are removed.
-        void remove(ConstEntity entity);
+        void remove(const_entity_type entity);
+
+        /// @brief Removes a component from an entity, leaving its other components in place.
+        /// Removing a component the entity doesn't have does nothing.
+        /// @tparam C The component type.
+        /// @param entity The entity from which the component is removed.
+        template<typename C>
+        void remove(const_entity_type entity);
 
         /// @brief Creates an immutable view over a set of components.
         /// @tparam Cs The component types to include in the view.
+        /// @param filters Optional exclude, optional, added and changed filters,
+        /// e.g. `view<Transform>(exclude<Movable>)`.
         /// @return An immutable view over the specified component types.
-        template<typename... Cs>
-        [[nodiscard]] ImmutableView<Cs...> view() const;
+        template<typename... Cs, typename... Fs>
+        [[nodiscard]] BasicView<BasicRegistry, true, detail::optional_filter_t<Fs...>, Cs...> view(Fs... filters) const;
 
         /// @brief Creates a mutable view over a set of components.
+        /// @details Accessing the components through a mutable view marks them as changed,
+        /// except those requested as const, e.g. `view<const Transform, Target>()`, which are only read.
         /// @tparam Cs The component types to include in the view.
+        /// @param filters Optional exclude, optional, added and changed filters,
+        /// e.g. `view<Transform>(exclude<Movable>)`.
         /// @return A mutable view over the specified component types.
-        template<typename... Cs>
-        [[nodiscard]] MutableView<Cs...> view();
+        template<typename... Cs, typename... Fs>
+        [[nodiscard]] BasicView<BasicRegistry, false, detail::optional_filter_t<Fs...>, Cs...> view(Fs... filters);
 
         /// @brief Compacts all storages, removing gaps in the entity IDs. Invalidates all iterators and references.
         void compact_all();
+
+        /// @brief Incrementally compacts storages within the budget of a policy. Invalidates all iterators and references.
+        /// @details Storages are visited round-robin, continuing where the previous call ran out of budget.
+        /// @param policy The compaction policy.
+        /// @return The number of tombstones removed.
+        size_t compact(const CompactionPolicy& policy);
+
+        /// @brief Sorts the storage of a component by a key and arranges the storages of other components in the same order.
+        /// @details Entities sharing the components are then laid out in the same order in all the storages,
+        /// so views over them stream through memory. Compacts the sorted storages. Invalidates all iterators and references.
+        /// @tparam C The component type the key is computed from.
+        /// @tparam Others The component types whose storages follow the order of C.
+        /// @param key Called with each component of type C, returns a totally ordered key.
+        template<typename C, typename... Others>
+        void sort_by(auto&& key);
+
+        /// @brief Gets the owning group of a set of components, creating it on first use.
+        /// @details The group takes over the order of the component storages: entities having all the components
+        /// are kept at the front of each storage, at the same dense index, so the group iterates them
+        /// without any lookups. Sorting an owned storage through sort_by() packs the group again.
+        /// Components requested as const are only handed out read-only, so they are not marked as changed.
+        /// @throws std::invalid_argument if one of the components is owned by another group,
+        /// or the group was created with the components in a different order or constness.
+        /// @tparam Cs The component types to own, none of them stored in a StablePool.
+        /// @return The group of the components.
+        template<typename... Cs>
+        BasicGroup<BasicRegistry, Cs...>& group();
+
+    private:
+        template<typename, bool, typename, typename...>
+        friend class BasicView;
+
+        template<typename, typename...>
+        friend class BasicGroup;
+
+        // Records a component in the signature of an entity
+        void mark(id_t entity_id, component_id_t component_id);
+
+        // Throws if the entity is not alive, so no component is ever added under a stale ID
+        void check_alive(id_t entity_id) const;
+
+        void check_alive(std::span<const id_t> entity_ids) const;
+
+        // Gets the number of storage slots, the highest component ID plus one
+        [[nodiscard]] size_t storage_count() const;
+
+        // Gets the storage of a component ID without knowing its type, or nullptr if it wasn't created yet
+        [[nodiscard]] StorageBase* storage_at(component_id_t component_id) const;
+
+        // Gets the storage of a component type, or nullptr if it wasn't created yet
+        template<typename C>
+        [[nodiscard]] const Storage<C>* find_storage() const;
+
+        // Resolves the change filters among the filters of a view
+        template<typename... Cs>
+        void add_tick_filter(std::vector<detail::TickFilter>& tick_filters, added_t<Cs...>) const;
+
+        template<typename... Cs>
+        void add_tick_filter(std::vector<detail::TickFilter>& tick_filters, changed_t<Cs...>) const;
+
+        void add_tick_filter(std::vector<detail::TickFilter>&, auto) const {}
+
+        // Creates a view, deducing the optional component types from the filter
+        template<bool Imm, typename... Cs, typename... Os>
+        [[nodiscard]] BasicView<BasicRegistry, Imm, optional_t<Os...>, Cs...> make_view(
+            optional_t<Os...>, const Signature& excluded, std::vector<detail::TickFilter> tick_filters) const;
     };
 
     /// @brief The base class for entity handles, providing access to the entity's ID and its components.
     /// @tparam Const If true, the entity handle is immutable; otherwise, it is mutable.
-    template<bool Const>
+    /// @tparam Reg The registry type managing the entity.
+    template<bool Const, typename Reg>
     class [[nodiscard]] EntityBase {
         id_t id_;
-        Registry* registry_;
+        Reg* registry_;
 
     public:
         /// @brief Constructs an EntityBase with a specific ID and registry.
-        EntityBase(id_t id, Registry* registry);
+        EntityBase(id_t id, Reg* registry);
 
         /// @brief Converts this mutable entity handle to an immutable entity handle.
-        [[nodiscard]] operator EntityBase<true>() const; // NOLINT
+        [[nodiscard]] operator EntityBase<true, Reg>() const; // NOLINT
 
         /// @brief Gets the ID of the entity.
         /// @return The ID of the entity.
         [[nodiscard]] id_t id() const;
 
+        /// @brief Gets the index part of the entity ID.
+        /// @return The index of the entity.
+        [[nodiscard]] id_t index() const;
+
+        /// @brief Gets the generation part of the entity ID.
+        /// @return The generation of the entity.
+        [[nodiscard]] id_t generation() const;
+
         /// @brief Checks if the entity has a specific component.
         /// @tparam Component The component type to check for.
         /// @return True if the entity has the component, false otherwise.
@@ -125,27 +558,27 @@ namespace sim {
 
         /// @brief Gets a specific component from the entity.
         /// @tparam Component The component type to get.
-        /// @return A const reference to the component.
+        /// @return A const reference to the component (a proxy for structure-of-arrays components).
         template<typename Component>
-        [[nodiscard]] const Component& get() const;
+        [[nodiscard]] const_reference_t<Component> get() const;
 
         /// @brief Gets a specific component from the entity.
         /// @tparam Component The component type to get.
-        /// @return A mutable reference to the component.
+        /// @return A mutable reference to the component (a proxy for structure-of-arrays components).
         template<typename Component>
-        [[nodiscard]] Component& get() requires(!Const);
+        [[nodiscard]] reference_t<Component> get() requires(!Const);
 
         /// @brief Gets all components of specified types from the entity. Useful for structured bindings.
         /// @tparam Components The component types to get.
         /// @return A tuple containing const references to the components.
         template<typename... Components>
-        [[nodiscard]] std::tuple<const Components &...> get_all() const;
+        [[nodiscard]] std::tuple<const_reference_t<Components>...> get_all() const;
 
         /// @brief Gets all components of specified types from the entity. Useful for structured bindings.
         /// @tparam Components The component types to get.
         /// @return A tuple containing mutable references to the components.
         template<typename... Components>
-        [[nodiscard]] std::tuple<Components &...> get_all() requires(!Const);
+        [[nodiscard]] std::tuple<reference_t<Components>...> get_all() requires(!Const);
 
         /// @brief Pushes a component to the entity.
         /// @tparam C The component type.
@@ -163,113 +596,541 @@ namespace sim {
         EntityBase& emplace(Args&&... args);
     };
 
+    /// @brief A handle to a batch of entities created together, for adding components to all of them at once.
+    /// @details Each operation fills one storage in a single linear pass.
+    /// @tparam Reg The registry type managing the entities.
+    template<typename Reg>
+    class [[nodiscard]] BasicEntityBatch {
+        std::vector<id_t> ids_;
+        Reg* registry_;
+
+    public:
+        /// @brief Constructs a batch over the given entity IDs and registry.
+        BasicEntityBatch(std::vector<id_t> ids, Reg* registry);
+
+        /// @brief Gets the IDs of the entities in the batch.
+        /// @return A span over the entity IDs, in creation order.
+        [[nodiscard]] std::span<const id_t> ids() const;
+
+        /// @brief Gets the number of entities in the batch.
+        /// @return The number of entities.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Gets a handle to an entity of the batch.
+        /// @param i The position of the entity in the batch.
+        /// @return A handle to the entity.
+        [[nodiscard]] EntityBase<false, Reg> operator[](size_t i) const;
+
+        /// @brief Emplaces a component constructed from the same arguments to all entities in the batch.
+        /// @tparam Component The component type.
+        /// @param args The arguments passed to every component constructor.
+        /// @return A reference to this batch, allowing for method chaining.
+        template<typename Component, typename... Args>
+        BasicEntityBatch& emplace(const Args&... args);
+
+        /// @brief Pushes a range of components, one to each entity in the batch.
+        /// @tparam Component The component type.
+        /// @param components The components to add, as many as there are entities, moved if the range owns them.
+        /// @return A reference to this batch, allowing for method chaining.
+        template<typename Component, std::ranges::sized_range R>
+        BasicEntityBatch& insert(R&& components);
+
+        /// @brief Pushes a component produced by a generator to each entity in the batch.
+        /// @tparam Component The component type.
+        /// @param generator Called for each entity in order, either with no arguments or with the entity ID.
+        /// @return A reference to this batch, allowing for method chaining.
+        template<typename Component>
+        BasicEntityBatch& generate(auto&& generator);
+    };
+
     // Implementation ============================================================================
 
+    inline GroupBase::GroupBase(const Signature& owned): owned_(owned) {}
+
+    inline const Signature& GroupBase::owned() const {
+        return owned_;
+    }
+
+    template<typename... Ks>
+    template<typename C>
+    constexpr component_id_t BasicRegistry<Ks...>::component_id() {
+        if constexpr (STATIC) {
+            using T = std::remove_const_t<C>;
+            static_assert((std::is_same_v<T, Ks> || ...), "Component type not in the component list of the registry");
+            return detail::index_of_v<T, Ks...>;
+        } else {
+            return get_component_id<C>();
+        }
+    }
+
+    template<typename... Ks>
+    tick_t BasicRegistry<Ks...>::tick() const {
+        return tick_;
+    }
+
+    template<typename... Ks>
+    void BasicRegistry<Ks...>::advance_tick() {
+        ++tick_;
+        for (size_t id = 0; id < storage_count(); ++id)
+            if (StorageBase* storage = storage_at(id))
+                storage->set_tick(tick_);
+    }
+
+    template<typename... Ks>
+    template<typename C>
+    std::vector<id_t> BasicRegistry<Ks...>::removed() const {
+        static_assert(is_tracked_v<C>, "Removals are only recorded for components opting in to change tracking");
+        const Storage<C>* storage = find_storage<C>();
+        return storage ? storage->removed_since(tick_ > 0 ? tick_ - 1 : 0) : std::vector<id_t>{};
+    }
+
+    template<typename... Ks>
     template<typename C>
-    const Storage<C>& Registry::get_storage() const {
-        auto id = get_component_id<C>();
-        if (id >= storages_.size()) { // TODO: only in debug
-            throw std::out_of_range("No storage for component type");
+    const Storage<C>& BasicRegistry<Ks...>::get_storage() const {
+        if constexpr (STATIC) {
+            return std::get<Storage<C> >(storages_);
+        } else {
+            auto id = component_id<C>();
+            if (id >= storages_.size() || !storages_[id]) { // TODO: only in debug
+                throw std::out_of_range("No storage for component type");
+            }
+            return static_cast<const Storage<C> &>(*storages_[id]);
         }
-        return static_cast<const Storage<C> &>(*storages_[id]);
     }
 
+    template<typename... Ks>
     template<typename C>
-    Storage<C>& Registry::get_storage() {
-        auto id = get_component_id<C>();
-        if (id >= storages_.size()) {
-            storages_.resize(id + 1);
-            storages_[id] = std::make_unique<Storage<C> >();
+    Storage<C>& BasicRegistry<Ks...>::get_storage() {
+        if constexpr (STATIC) {
+            return std::get<Storage<C> >(storages_);
+        } else {
+            auto id = component_id<C>();
+            if (id >= storages_.size()) {
+                if (id >= MAX_COMPONENTS)
+                    throw std::length_error("Too many component types, increase SIM_MAX_COMPONENTS");
+                storages_.resize(id + 1);
+            }
+            if (!storages_[id]) {
+                storages_[id] = std::make_unique<Storage<C> >();
+                storages_[id]->set_tick(tick_);
+            }
+            return static_cast<Storage<C> &>(*storages_[id]);
         }
-        return static_cast<Storage<C> &>(*storages_[id]);
     }
 
+    template<typename... Ks>
+    template<typename C>
+    bool BasicRegistry<Ks...>::has(const id_t entity_id) const {
+        // Component types beyond the signature width never got a storage, so no entity has them
+        const component_id_t id = component_id<C>();
+        return id < MAX_COMPONENTS && ids_.alive(entity_id) && signatures_[to_index(entity_id)].test(id);
+    }
+
+    template<typename... Ks>
+    template<typename C>
+    reference_t<C> BasicRegistry<Ks...>::get(const id_t entity_id) {
+        return get_storage<C>().get(entity_id);
+    }
+
+    template<typename... Ks>
+    template<typename C>
+    const_reference_t<C> BasicRegistry<Ks...>::get(const id_t entity_id) const {
+        return get_storage<C>().get(entity_id);
+    }
+
+    template<typename... Ks>
+    Signature BasicRegistry<Ks...>::signature(const id_t entity_id) const {
+        return ids_.alive(entity_id) ? signatures_[to_index(entity_id)] : Signature{};
+    }
+
+    template<typename... Ks>
     template<typename Component>
-    void Registry::push_back(const ConstEntity entity, Component&& component) {
+    void BasicRegistry<Ks...>::push_back(const const_entity_type entity, Component&& component) {
+        check_alive(entity.id());
         auto& storage = get_storage<std::decay_t<Component> >();
         storage.push_back(entity.id(), std::forward<Component>(component));
+        mark(entity.id(), component_id<std::decay_t<Component> >());
     }
 
+    template<typename... Ks>
     template<typename Component, typename... Args>
-    void Registry::emplace(const ConstEntity entity, Args&&... args) {
+    void BasicRegistry<Ks...>::emplace(const const_entity_type entity, Args&&... args) {
+        check_alive(entity.id());
         auto& storage = get_storage<Component>();
         storage.emplace(entity.id(), std::forward<Args>(args)...);
+        mark(entity.id(), component_id<Component>());
+    }
+
+    template<typename... Ks>
+    template<typename Component, typename... Args>
+    void BasicRegistry<Ks...>::emplace_many(const std::span<const id_t> entity_ids, const Args&... args) {
+        check_alive(entity_ids);
+        get_storage<Component>().emplace_many(entity_ids, args...);
+        for (const id_t entity_id: entity_ids)
+            mark(entity_id, component_id<Component>());
+    }
+
+    template<typename... Ks>
+    template<typename Component, std::ranges::sized_range R>
+    void BasicRegistry<Ks...>::insert(const std::span<const id_t> entity_ids, R&& components) {
+        check_alive(entity_ids);
+        get_storage<Component>().insert(entity_ids, std::forward<R>(components));
+        for (const id_t entity_id: entity_ids)
+            mark(entity_id, component_id<Component>());
+    }
+
+    template<typename... Ks>
+    template<typename Component>
+    void BasicRegistry<Ks...>::generate(const std::span<const id_t> entity_ids, auto&& generator) {
+        check_alive(entity_ids);
+        get_storage<Component>().generate(entity_ids, std::forward<decltype(generator)>(generator));
+        for (const id_t entity_id: entity_ids)
+            mark(entity_id, component_id<Component>());
+    }
+
+    template<typename... Ks>
+    void BasicRegistry<Ks...>::mark(const id_t entity_id, const component_id_t component_id) {
+        const id_t index = to_index(entity_id);
+        if (index >= signatures_.size())
+            signatures_.resize(index + 1);
+        signatures_[index].set(component_id);
+        if (component_id < owners_.size() && owners_[component_id])
+            owners_[component_id]->on_construct(entity_id);
+    }
+
+    template<typename... Ks>
+    void BasicRegistry<Ks...>::check_alive(const id_t entity_id) const {
+        if (!ids_.alive(entity_id))
+            throw std::out_of_range("Entity is not alive");
+    }
+
+    template<typename... Ks>
+    void BasicRegistry<Ks...>::check_alive(const std::span<const id_t> entity_ids) const {
+        for (const id_t entity_id: entity_ids)
+            check_alive(entity_id);
+    }
+
+    template<typename... Ks>
+    size_t BasicRegistry<Ks...>::storage_count() const {
+        if constexpr (STATIC)
+            return sizeof...(Ks);
+        else
+            return storages_.size();
+    }
+
+    template<typename... Ks>
+    StorageBase* BasicRegistry<Ks...>::storage_at(const component_id_t component_id) const {
+        if constexpr (STATIC) {
+            return std::apply([&](const auto&... storage) {
+                const std::array<const StorageBase*, sizeof...(Ks)> all{&storage...};
+                return const_cast<StorageBase*>(all[component_id]);
+            }, storages_);
+        } else {
+            return component_id < storages_.size() ? storages_[component_id].get() : nullptr;
+        }
     }
 
-    inline void Registry::remove(const ConstEntity entity) { // NOLINT
-        for (auto&& storage: storages_)
-            storage->remove(entity.id());
+    template<typename... Ks>
+    typename BasicRegistry<Ks...>::entity_type BasicRegistry<Ks...>::create() {
+        const id_t id = ids_.create();
+        if (to_index(id) >= signatures_.size())
+            signatures_.resize(to_index(id) + 1);
+        signatures_[to_index(id)].clear(); // A recycled index starts without any component
+        return {id, this};
     }
 
+    template<typename... Ks>
+    BasicEntityBatch<BasicRegistry<Ks...> > BasicRegistry<Ks...>::create_many(const size_t n) {
+        std::vector<id_t> ids;
+        ids_.create_many(n, ids);
+        if (ids_.capacity() > signatures_.size())
+            signatures_.resize(ids_.capacity());
+        for (const id_t id: ids)
+            signatures_[to_index(id)].clear(); // Recycled indices start without any component
+        return {std::move(ids), this};
+    }
+
+    template<typename... Ks>
+    bool BasicRegistry<Ks...>::alive(const id_t entity_id) const {
+        return ids_.alive(entity_id);
+    }
+
+    template<typename... Ks>
+    size_t BasicRegistry<Ks...>::size() const {
+        return ids_.size();
+    }
+
+    template<typename... Ks>
+    void BasicRegistry<Ks...>::remove(const const_entity_type entity) { // NOLINT
+        if (!ids_.release(entity.id())) return;
+        if (to_index(entity.id()) >= signatures_.size()) return; // No components
+
+        Signature& signature = signatures_[to_index(entity.id())];
+        signature.for_each([&](const component_id_t component_id) {
+            if (component_id < owners_.size() && owners_[component_id])
+                owners_[component_id]->on_destroy(entity.id()); // Move it out of the group first
+            storage_at(component_id)->remove(entity.id());
+        });
+        signature.clear();
+    }
+
+    template<typename... Ks>
+    template<typename C>
+    void BasicRegistry<Ks...>::remove(const const_entity_type entity) { // NOLINT
+        if (!has<C>(entity.id())) return;
+        const component_id_t id = component_id<C>();
+        if (id < owners_.size() && owners_[id])
+            owners_[id]->on_destroy(entity.id()); // Move it out of the group first
+        get_storage<C>().remove(entity.id());
+        signatures_[to_index(entity.id())].reset(id);
+    }
+
+    template<typename... Ks>
+    template<typename... Cs, typename... Fs>
+    BasicView<BasicRegistry<Ks...>, true, detail::optional_filter_t<Fs...>, Cs...>
+    BasicRegistry<Ks...>::view(Fs... filters) const {
+        Signature excluded;
+        (detail::add_excluded<BasicRegistry>(excluded, filters), ...);
+        std::vector<detail::TickFilter> tick_filters;
+        (add_tick_filter(tick_filters, filters), ...);
+        return make_view<true, Cs...>(detail::optional_filter_t<Fs...>{}, excluded, std::move(tick_filters));
+    }
+
+    template<typename... Ks>
+    template<typename... Cs, typename... Fs>
+    BasicView<BasicRegistry<Ks...>, false, detail::optional_filter_t<Fs...>, Cs...>
+    BasicRegistry<Ks...>::view(Fs... filters) {
+        Signature excluded;
+        (detail::add_excluded<BasicRegistry>(excluded, filters), ...);
+        std::vector<detail::TickFilter> tick_filters;
+        (add_tick_filter(tick_filters, filters), ...);
+        return make_view<false, Cs...>(detail::optional_filter_t<Fs...>{}, excluded, std::move(tick_filters));
+    }
+
+    template<typename... Ks>
     template<typename... Cs>
-    ImmutableView<Cs...> Registry::view() const {
-        return ImmutableView<Cs...>(&get_storage<Cs>()..., this);
+    void BasicRegistry<Ks...>::add_tick_filter(std::vector<detail::TickFilter>& tick_filters, added_t<Cs...>) const {
+        (tick_filters.push_back({find_storage<Cs>(), true}), ...);
     }
 
+    template<typename... Ks>
     template<typename... Cs>
-    MutableView<Cs...> Registry::view() {
-        return MutableView<Cs...>(&get_storage<Cs>()..., this);
+    void BasicRegistry<Ks...>::add_tick_filter(std::vector<detail::TickFilter>& tick_filters, changed_t<Cs...>) const {
+        (tick_filters.push_back({find_storage<Cs>(), false}), ...);
+    }
+
+    template<typename... Ks>
+    template<typename C>
+    const Storage<C>* BasicRegistry<Ks...>::find_storage() const {
+        if constexpr (STATIC) {
+            return &std::get<Storage<C> >(storages_);
+        } else {
+            const auto id = component_id<C>();
+            return id < storages_.size() ? static_cast<const Storage<C>*>(storages_[id].get()) : nullptr;
+        }
+    }
+
+    template<typename... Ks>
+    template<bool Imm, typename... Cs, typename... Os>
+    BasicView<BasicRegistry<Ks...>, Imm, optional_t<Os...>, Cs...> BasicRegistry<Ks...>::make_view(
+        optional_t<Os...>, const Signature& excluded, std::vector<detail::TickFilter> tick_filters) const {
+        using view_t = BasicView<BasicRegistry, Imm, optional_t<Os...>, Cs...>;
+        // Immutable views only hand out const entity handles, which never modify the registry,
+        // and mutable views are only made by the non-const view()
+        auto* self = const_cast<BasicRegistry*>(this);
+        if constexpr (Imm) {
+            // Storages not created yet are stood in for by an empty one, so the view iterates nothing
+            const auto storage_or_empty = []<typename C>(const Storage<C>* storage) {
+                static const Storage<C> empty;
+                return storage ? storage : &empty;
+            };
+            return view_t(storage_or_empty(find_storage<std::remove_const_t<Cs> >())..., self, excluded,
+                          std::tuple{find_storage<std::remove_const_t<Os> >()...}, std::move(tick_filters));
+        } else {
+            // Components requested as const convert to pointers to const storages
+            return view_t(&self->template get_storage<std::remove_const_t<Cs> >()..., self, excluded,
+                          std::tuple{&self->template get_storage<std::remove_const_t<Os> >()...},
+                          std::move(tick_filters));
+        }
     }
 
-    inline void Registry::compact_all() { // NOLINT
-        for (auto&& storage : storages_)
-            storage->compact();
+    template<typename... Ks>
+    void BasicRegistry<Ks...>::compact_all() { // NOLINT
+        for (size_t id = 0; id < storage_count(); ++id)
+            if (StorageBase* storage = storage_at(id))
+                storage->compact();
     }
 
-    template<bool Const>
-    EntityBase<Const>::EntityBase(const id_t id, Registry* registry): id_(id), registry_(registry) {}
+    template<typename... Ks>
+    size_t BasicRegistry<Ks...>::compact(const CompactionPolicy& policy) {
+        using clock = std::chrono::steady_clock;
+        const bool timed = policy.time_budget.count() > 0;
+        const auto deadline = clock::now() + policy.time_budget;
+        const size_t budget = policy.element_budget == 0 ? std::numeric_limits<size_t>::max() : policy.element_budget;
+
+        size_t removed = 0;
+        for (size_t n = 0; n < storage_count(); ++n) {
+            const size_t current = (compaction_cursor_ + n) % storage_count();
+            StorageBase* storage = storage_at(current);
+            if (!storage || storage->tombstones() == 0
+                || static_cast<double>(storage->tombstones()) < policy.min_tombstone_ratio * storage->size())
+                continue;
+
+            while (storage->tombstones() > 0) {
+                const size_t slice = std::min(budget - removed, timed ? COMPACTION_SLICE : budget);
+                const size_t done = storage->compact(slice);
+                removed += done;
+                if (removed >= budget || (timed && clock::now() >= deadline)) {
+                    compaction_cursor_ = current; // Out of budget, continue here next time
+                    return removed;
+                }
+                if (done == 0) break;
+            }
+        }
+        return removed;
+    }
+
+    template<typename... Ks>
+    template<typename C, typename... Others>
+    void BasicRegistry<Ks...>::sort_by(auto&& key) {
+        Storage<C>& leader = get_storage<C>();
+        leader.sort_by_key([&](const id_t id) { return key(std::as_const(leader).get(id)); });
+        (get_storage<Others>().sort_as(leader), ...);
+
+        for (const component_id_t id: {component_id<C>(), component_id<Others>()...})
+            if (id < owners_.size() && owners_[id])
+                owners_[id]->rebuild(); // Rebuilding an already packed group is cheap
+    }
 
-    template<bool Const>
-    EntityBase<Const>::operator EntityBase<true>() const {
+    template<typename... Ks>
+    template<typename... Cs>
+    BasicGroup<BasicRegistry<Ks...>, Cs...>& BasicRegistry<Ks...>::group() {
+        static_assert(sizeof...(Cs) > 0, "A group needs at least one component");
+        static_assert((!is_stable_v<std::remove_const_t<Cs> > && ...),
+                      "Components in a StablePool can't be owned by a group");
+        using group_t = BasicGroup<BasicRegistry, Cs...>;
+
+        Signature owned;
+        (owned.set(component_id<Cs>()), ...);
+        for (const component_id_t id: {component_id<Cs>()...}) {
+            if (id >= owners_.size() || !owners_[id]) continue;
+            if (owners_[id]->owned() != owned)
+                throw std::invalid_argument("Component already owned by another group");
+            if (auto* existing = dynamic_cast<group_t*>(owners_[id]))
+                return *existing;
+            throw std::invalid_argument("Group already created with a different component order or constness");
+        }
+
+        auto& group = *groups_.emplace_back(std::make_unique<group_t>(this, &get_storage<std::remove_const_t<Cs> >()...));
+        owners_.resize(storage_count());
+        (void(owners_[component_id<Cs>()] = &group), ...);
+        return static_cast<group_t&>(group);
+    }
+
+    template<bool Const, typename Reg>
+    EntityBase<Const, Reg>::EntityBase(const id_t id, Reg* registry): id_(id), registry_(registry) {}
+
+    template<bool Const, typename Reg>
+    EntityBase<Const, Reg>::operator EntityBase<true, Reg>() const {
         return {id_, registry_};
     }
 
-    template<bool Const>
-    id_t EntityBase<Const>::id() const {
+    template<bool Const, typename Reg>
+    id_t EntityBase<Const, Reg>::id() const {
         return id_;
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
+    id_t EntityBase<Const, Reg>::index() const {
+        return to_index(id_);
+    }
+
+    template<bool Const, typename Reg>
+    id_t EntityBase<Const, Reg>::generation() const {
+        return to_generation(id_);
+    }
+
+    template<bool Const, typename Reg>
     template<typename Component>
-    bool EntityBase<Const>::has() const {
-        return registry_->get_storage<Component>().entity_has(id_);
+    bool EntityBase<Const, Reg>::has() const {
+        return registry_->template has<Component>(id_);
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
     template<typename Component>
-    const Component& EntityBase<Const>::get() const {
-        return registry_->get_storage<Component>().get(id_);
+    const_reference_t<Component> EntityBase<Const, Reg>::get() const {
+        return registry_->template get<Component>(id_);
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
     template<typename Component>
-    Component& EntityBase<Const>::get() requires(!Const) {
-        return registry_->get_storage<Component>().get(id_);
+    reference_t<Component> EntityBase<Const, Reg>::get() requires(!Const) {
+        return registry_->template get<Component>(id_);
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
     template<typename... Components>
-    std::tuple<const Components &...> EntityBase<Const>::get_all() const {
+    std::tuple<const_reference_t<Components>...> EntityBase<Const, Reg>::get_all() const {
         return {get<Components>()...};
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
     template<typename... Components>
-    std::tuple<Components &...> EntityBase<Const>::get_all() requires(!Const) {
+    std::tuple<reference_t<Components>...> EntityBase<Const, Reg>::get_all() requires(!Const) {
         return {get<Components>()...};
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
     template<typename C>
-    EntityBase<Const>& EntityBase<Const>::push_back(C&& component) {
+    EntityBase<Const, Reg>& EntityBase<Const, Reg>::push_back(C&& component) {
         registry_->push_back(*this, std::forward<C>(component));
         return *this;
     }
 
-    template<bool Const>
+    template<bool Const, typename Reg>
     template<typename Component, typename... Args>
-    EntityBase<Const>& EntityBase<Const>::emplace(Args&&... args) {
-        registry_->emplace<Component>(*this, std::forward<Args>(args)...);
+    EntityBase<Const, Reg>& EntityBase<Const, Reg>::emplace(Args&&... args) {
+        registry_->template emplace<Component>(*this, std::forward<Args>(args)...);
+        return *this;
+    }
+
+    template<typename Reg>
+    BasicEntityBatch<Reg>::BasicEntityBatch(std::vector<id_t> ids, Reg* registry):
+        ids_(std::move(ids)), registry_(registry) {}
+
+    template<typename Reg>
+    std::span<const id_t> BasicEntityBatch<Reg>::ids() const {
+        return ids_;
+    }
+
+    template<typename Reg>
+    size_t BasicEntityBatch<Reg>::size() const {
+        return ids_.size();
+    }
+
+    template<typename Reg>
+    EntityBase<false, Reg> BasicEntityBatch<Reg>::operator[](const size_t i) const {
+        return {ids_[i], registry_};
+    }
+
+    template<typename Reg>
+    template<typename Component, typename... Args>
+    BasicEntityBatch<Reg>& BasicEntityBatch<Reg>::emplace(const Args&... args) {
+        registry_->template emplace_many<Component>(ids_, args...);
+        return *this;
+    }
+
+    template<typename Reg>
+    template<typename Component, std::ranges::sized_range R>
+    BasicEntityBatch<Reg>& BasicEntityBatch<Reg>::insert(R&& components) {
+        registry_->template insert<Component>(ids_, std::forward<R>(components));
+        return *this;
+    }
+
+    template<typename Reg>
+    template<typename Component>
+    BasicEntityBatch<Reg>& BasicEntityBatch<Reg>::generate(auto&& generator) {
+        registry_->template generate<Component>(ids_, std::forward<decltype(generator)>(generator));
         return *this;
     }
 };
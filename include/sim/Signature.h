@@ -0,0 +1,109 @@
+#ifndef SIGNATURE_H
+#define SIGNATURE_H
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#ifndef SIM_MAX_COMPONENTS
+/// @brief Maximal number of distinct component types, i.e. the width of entity signatures.
+#define SIM_MAX_COMPONENTS 128
+#endif
+
+namespace sim {
+    /// @brief Maximal number of distinct component types.
+    constexpr size_t MAX_COMPONENTS = SIM_MAX_COMPONENTS;
+
+    /// @brief A fixed-width bit set of component IDs, describing which components an entity has.
+    /// @tparam Bits The number of bits.
+    template<size_t Bits>
+    class BasicSignature {
+        using word_t = uint64_t;
+        static constexpr size_t WORD_BITS = 64;
+        std::array<word_t, (Bits + WORD_BITS - 1) / WORD_BITS> words_{};
+
+    public:
+        /// @brief Sets a bit.
+        /// @param bit The index of the bit.
+        void set(size_t bit);
+
+        /// @brief Clears a bit.
+        /// @param bit The index of the bit.
+        void reset(size_t bit);
+
+        /// @brief Clears all bits.
+        void clear();
+
+        /// @brief Tests a bit.
+        /// @param bit The index of the bit.
+        /// @return Whether the bit is set.
+        [[nodiscard]] bool test(size_t bit) const;
+
+        /// @brief Checks if all bits set in another signature are set in this one.
+        /// @param other The other signature.
+        /// @return Whether this signature is a superset of the other.
+        [[nodiscard]] bool contains(const BasicSignature& other) const;
+
+        /// @brief Checks if any bit is set in both signatures.
+        /// @param other The other signature.
+        /// @return Whether the signatures intersect.
+        [[nodiscard]] bool intersects(const BasicSignature& other) const;
+
+        /// @brief Calls a callable with the index of every set bit, in increasing order.
+        /// @param callable The callable to call.
+        void for_each(auto&& callable) const;
+
+        /// @brief Checks if two signatures are equal.
+        [[nodiscard]] bool operator==(const BasicSignature&) const = default;
+    };
+
+    /// @brief Signature wide enough for all component types.
+    using Signature = BasicSignature<MAX_COMPONENTS>;
+
+    // Implementation ============================================================================
+
+    template<size_t Bits>
+    void BasicSignature<Bits>::set(const size_t bit) {
+        words_[bit / WORD_BITS] |= word_t{1} << (bit % WORD_BITS);
+    }
+
+    template<size_t Bits>
+    void BasicSignature<Bits>::reset(const size_t bit) {
+        words_[bit / WORD_BITS] &= ~(word_t{1} << (bit % WORD_BITS));
+    }
+
+    template<size_t Bits>
+    void BasicSignature<Bits>::clear() {
+        words_.fill(0);
+    }
+
+    template<size_t Bits>
+    bool BasicSignature<Bits>::test(const size_t bit) const {
+        return words_[bit / WORD_BITS] >> (bit % WORD_BITS) & 1;
+    }
+
+    template<size_t Bits>
+    bool BasicSignature<Bits>::contains(const BasicSignature& other) const {
+        for (size_t i = 0; i < words_.size(); ++i)
+            if ((words_[i] & other.words_[i]) != other.words_[i])
+                return false;
+        return true;
+    }
+
+    template<size_t Bits>
+    bool BasicSignature<Bits>::intersects(const BasicSignature& other) const {
+        for (size_t i = 0; i < words_.size(); ++i)
+            if (words_[i] & other.words_[i])
+                return true;
+        return false;
+    }
+
+    template<size_t Bits>
+    void BasicSignature<Bits>::for_each(auto&& callable) const {
+        for (size_t i = 0; i < words_.size(); ++i) {
+            for (word_t word = words_[i]; word != 0; word &= word - 1)
+                callable(i * WORD_BITS + std::countr_zero(word));
+        }
+    }
+}
+
+#endif //SIGNATURE_H
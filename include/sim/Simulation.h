@@ -4,65 +4,149 @@
 #include "Event.h"
 #include "Storage.h"
 #include "Dispatcher.h"
+#include "ThreadPool.h"
 
 /// @brief The main namespace for the simulation framework.
 namespace sim {
 
     /// @brief The main simulation class that manages the lifecycle of the simulation.
+    /// @tparam Reg The registry (storage backend) holding the entities and components.
     /// @tparam Ss The systems that will be used in the simulation.
-    template<typename... Ss>
-    class Simulation final {
-        static constexpr size_t COMPACTION_CYCLES = 100;
-        Registry registry_;
+    template<typename Reg, typename... Ss>
+    class BasicSimulation final {
+        using context_t = BasicContext<Reg>;
+
+        Reg registry_;
+        CompactionPolicy compaction_policy_{};
         Dispatcher<Ss...> dispatcher_{};
+        size_t threads_ = ThreadPool::default_threads();
+        std::unique_ptr<ThreadPool> pool_; // Runs parallel loops of systems, started by the first run
+        BasicCommandBuffer<Reg> commands_; // Structural changes recorded by systems, one part per thread of the pool
         size_t cycle_ = 0;
-        id_t entity_id_ = 0;
 
     public:
         /// @brief Default constructor for the Simulation class.
-        explicit Simulation() = default;
+        explicit BasicSimulation() = default;
 
         /// @brief A fluent interface to add systems to the simulation.
         /// @tparam S The system types to add.
         /// @return A new Simulation instance with the added systems.
         template<typename... S>
         constexpr auto with_systems() const {
-            return Simulation<Ss..., S...>{};
+            return BasicSimulation<Reg, Ss..., S...>{};
+        }
+
+        /// @brief A fluent interface to select the registry (storage backend) of the simulation.
+        /// @tparam R The registry type, e.g. Registry or ArchetypeRegistry.
+        /// @return A new Simulation instance with the same systems, using the given registry.
+        template<typename R>
+        constexpr auto with_backend() const {
+            return BasicSimulation<R, Ss...>{};
+        }
+
+        /// @brief A fluent interface to fix the component types of the simulation at compile time.
+        /// @details Selects a BasicRegistry over the given types, whose component IDs are compile-time constants
+        /// and whose storages are held in place. Systems should take their context as `ContextC auto`
+        /// rather than Context, which belongs to the default registry.
+        /// @tparam Cs The component types, all of those the systems and entities use.
+        /// @return A new Simulation instance with the same systems, using a registry of the given components.
+        template<typename... Cs>
+        constexpr auto with_components() const {
+            return BasicSimulation<BasicRegistry<Cs...>, Ss...>{};
         }
 
         /// @brief Returns the current simulation cycle.
         /// @return The current cycle number.
         [[nodiscard]] size_t cycle() const;
 
+        /// @brief Returns the policy used to compact storages after every cycle.
+        /// @return The compaction policy.
+        [[nodiscard]] const CompactionPolicy& compaction_policy() const;
+
+        /// @brief Sets the policy used to compact storages after every cycle.
+        /// @param policy The new compaction policy.
+        void set_compaction_policy(const CompactionPolicy& policy);
+
+        /// @brief Sets the number of worker threads running the parallel loops of systems,
+        /// and the systems declaring disjoint component accesses concurrently (see Dispatcher).
+        /// @details Defaults to one less than the hardware threads, as the simulation thread takes part too.
+        /// The threads are started by the next run, so simulations that never run don't start any.
+        /// @param threads The number of worker threads. With none, parallel loops and systems run on the simulation
+        /// thread, in declaration order.
+        void set_threads(size_t threads);
+
         /// @brief Runs the simulation for a specified number of cycles.
+        /// @details The structural changes recorded in the command buffer of the context
+        /// are applied after every event, see BasicContext::commands().
         /// @param cycles The number of cycles to run the simulation.
         void run(size_t cycles);
 
-        /// @brief Creates a new entity in the simulation.
+        /// @brief Creates a new entity in the simulation. IDs of removed entities are recycled with a new generation.
+        /// @throws std::length_error if the entity index space is exhausted.
         /// @return A new Entity object representing the created entity.
-        Entity create();
+        typename Reg::entity_type create();
+
+        /// @brief Creates a number of entities at once, to which components can be added in bulk.
+        /// @throws std::length_error if the entity index space would be exhausted.
+        /// @param n The number of entities to create.
+        /// @return A batch handle to the created entities.
+        BasicEntityBatch<Reg> create_many(size_t n);
 
     private:
         template<typename Event>
-        void dispatch_to_all(const Event& event, Context& ctx);
+        void dispatch_to_all(const Event& event, context_t& ctx);
 
         void compact_storages();
     };
 
+    /// @brief A simulation using the default, sparse set based Registry.
+    /// @tparam Ss The systems that will be used in the simulation.
+    template<typename... Ss>
+    using Simulation = BasicSimulation<Registry, Ss...>;
+
     // Implementation ============================================================================
 
-    template<typename... Ss>
-    size_t Simulation<Ss...>::cycle() const {
+    template<typename Reg, typename... Ss>
+    size_t BasicSimulation<Reg, Ss...>::cycle() const {
         return cycle_;
     }
 
-    template<typename... Ss>
-    void Simulation<Ss...>::run(const size_t cycles) {
-        Context start_ctx(&registry_, cycle_);
+    template<typename Reg, typename... Ss>
+    const CompactionPolicy& BasicSimulation<Reg, Ss...>::compaction_policy() const {
+        return compaction_policy_;
+    }
+
+    template<typename Reg, typename... Ss>
+    void BasicSimulation<Reg, Ss...>::set_compaction_policy(const CompactionPolicy& policy) {
+        compaction_policy_ = policy;
+    }
+
+    template<typename Reg, typename... Ss>
+    void BasicSimulation<Reg, Ss...>::set_threads(const size_t threads) {
+        threads_ = threads;
+        pool_.reset(); // Restarted with the new number of threads by the next run
+    }
+
+    template<typename Reg, typename... Ss>
+    void BasicSimulation<Reg, Ss...>::run(const size_t cycles) {
+        if (!pool_) {
+            pool_ = std::make_unique<ThreadPool>(threads_);
+            commands_ = BasicCommandBuffer<Reg>(pool_.get());
+        }
+        commands_.apply(registry_); // Nothing to apply, makes this thread the owner of the buffer
+
+        // Systems running concurrently must not create storages, so those they declare are created upfront
+        Dispatcher<Ss...>::for_each_declared([&]<typename C>(std::type_identity<C>) {
+            if constexpr (requires { registry_.template get_storage<C>(); })
+                (void) registry_.template get_storage<C>();
+        });
+
+        context_t start_ctx(&registry_, cycle_, pool_.get(), &commands_);
         dispatch_to_all(event::SimStart{}, start_ctx);
 
         for (size_t i = 0; i < cycles; ++i) {
-            Context ctx(&registry_, cycle_);
+            registry_.advance_tick(); // Changes of the previous cycle stay visible for one more cycle
+            context_t ctx(&registry_, cycle_, pool_.get(), &commands_);
             dispatch_to_all(event::PreCycle{}, ctx);
             dispatch_to_all(event::Cycle{}, ctx);
             dispatch_to_all(event::PostCycle{}, ctx);
@@ -71,25 +155,30 @@ namespace sim {
             ++cycle_;
         }
 
-        Context end_ctx(&registry_, cycle_);
+        context_t end_ctx(&registry_, cycle_, pool_.get(), &commands_);
         dispatch_to_all(event::SimEnd{}, end_ctx);
     }
 
-    template<typename... Ss>
-    Entity Simulation<Ss...>::create() {
-        return {entity_id_++, &registry_};
+    template<typename Reg, typename... Ss>
+    typename Reg::entity_type BasicSimulation<Reg, Ss...>::create() {
+        return registry_.create();
     }
 
-    template<typename... Ss>
+    template<typename Reg, typename... Ss>
+    BasicEntityBatch<Reg> BasicSimulation<Reg, Ss...>::create_many(const size_t n) {
+        return registry_.create_many(n);
+    }
+
+    template<typename Reg, typename... Ss>
     template<typename Event>
-    void Simulation<Ss...>::dispatch_to_all(const Event& event, Context& ctx) {
-        dispatcher_.template dispatch_to_all<Event>(event, ctx);
+    void BasicSimulation<Reg, Ss...>::dispatch_to_all(const Event& event, context_t& ctx) {
+        dispatcher_.template dispatch_to_all<Event>(event, ctx, pool_.get());
+        commands_.apply(registry_); // Structural changes recorded during the event take effect before the next one
     }
 
-    template<typename... Ss>
-    void Simulation<Ss...>::compact_storages() {
-        if (cycle_ % COMPACTION_CYCLES == 0)
-            registry_.compact_all();
+    template<typename Reg, typename... Ss>
+    void BasicSimulation<Reg, Ss...>::compact_storages() {
+        registry_.compact(compaction_policy_);
     }
 }
 
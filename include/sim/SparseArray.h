@@ -0,0 +1,112 @@
+#ifndef SPARSEARRAY_H
+#define SPARSEARRAY_H
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "Types.h"
+
+namespace sim {
+    /// @brief A paged sparse array mapping entity indices to values.
+    /// @details The array is split into fixed-size pages that are allocated lazily on first write.
+    /// Missing pages read as the empty value and cost only a null pointer,
+    /// so memory scales with the entities actually stored rather than with the largest entity index.
+    /// @tparam V The value type stored in the array.
+    /// @tparam Empty The value reported for unset entries.
+    /// @tparam PageSize The number of entries per page, must be a power of two.
+    template<typename V, V Empty = std::numeric_limits<V>::max(), size_t PageSize = 4096>
+    class SparseArray {
+        static_assert((PageSize & (PageSize - 1)) == 0, "Page size must be a power of two");
+
+        using page_t = std::array<V, PageSize>;
+        std::vector<std::unique_ptr<page_t> > pages_;
+
+    public:
+        /// @brief The value reported for unset entries.
+        static constexpr V EMPTY = Empty;
+
+        /// @brief Default constructor.
+        explicit SparseArray() = default;
+
+        /// @brief Get the value for an index, or EMPTY if the index was never set.
+        /// @param index The entity index to look up.
+        /// @return The stored value or EMPTY.
+        [[nodiscard]] V get(id_t index) const;
+
+        /// @brief Get a reference to an entry that is known to live on an allocated page.
+        /// @param index The entity index, previously written through assure().
+        /// @return A reference to the entry.
+        [[nodiscard]] V& ref(id_t index);
+
+        /// @brief Get a reference to an entry, allocating its page if needed.
+        /// @param index The entity index.
+        /// @return A reference to the entry.
+        [[nodiscard]] V& assure(id_t index);
+
+        /// @brief Get the number of allocated pages.
+        /// @return The number of allocated pages.
+        [[nodiscard]] size_t page_count() const;
+
+        /// @brief Release all pages whose entries are all empty.
+        void shrink();
+
+    private:
+        static constexpr size_t page_of(id_t index);
+        static constexpr size_t offset_of(id_t index);
+    };
+
+    // Implementation ============================================================================
+
+    template<typename V, V Empty, size_t PageSize>
+    V SparseArray<V, Empty, PageSize>::get(const id_t index) const {
+        const size_t page = page_of(index);
+        if (page >= pages_.size() || !pages_[page])
+            return EMPTY;
+        return (*pages_[page])[offset_of(index)];
+    }
+
+    template<typename V, V Empty, size_t PageSize>
+    V& SparseArray<V, Empty, PageSize>::ref(const id_t index) {
+        return (*pages_[page_of(index)])[offset_of(index)];
+    }
+
+    template<typename V, V Empty, size_t PageSize>
+    V& SparseArray<V, Empty, PageSize>::assure(const id_t index) {
+        const size_t page = page_of(index);
+        if (page >= pages_.size())
+            pages_.resize(page + 1);
+        if (!pages_[page]) {
+            pages_[page] = std::make_unique<page_t>();
+            pages_[page]->fill(EMPTY);
+        }
+        return (*pages_[page])[offset_of(index)];
+    }
+
+    template<typename V, V Empty, size_t PageSize>
+    size_t SparseArray<V, Empty, PageSize>::page_count() const {
+        return std::ranges::count_if(pages_, [](const auto& page) { return page != nullptr; });
+    }
+
+    template<typename V, V Empty, size_t PageSize>
+    void SparseArray<V, Empty, PageSize>::shrink() {
+        for (auto& page: pages_)
+            if (page && std::ranges::all_of(*page, [](const V value) { return value == EMPTY; }))
+                page.reset();
+        while (!pages_.empty() && !pages_.back())
+            pages_.pop_back();
+    }
+
+    template<typename V, V Empty, size_t PageSize>
+    constexpr size_t SparseArray<V, Empty, PageSize>::page_of(const id_t index) {
+        return index / PageSize;
+    }
+
+    template<typename V, V Empty, size_t PageSize>
+    constexpr size_t SparseArray<V, Empty, PageSize>::offset_of(const id_t index) {
+        return index & (PageSize - 1);
+    }
+}
+
+#endif //SPARSEARRAY_H
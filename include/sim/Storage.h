@@ -4,34 +4,105 @@
 #include <vector>
 #include <memory>
 #include <numeric>
+#include <ranges>
+#include <span>
 
+#include "Pool.h"
+#include "SparseArray.h"
 #include "Types.h"
 
 namespace sim {
+    namespace detail {
+        /// @brief Reads the element of a range of components to insert, moving it out of containers passed as rvalues.
+        /// @details Views are read by copy, as they may refer to components the caller still owns.
+        /// @tparam R The range type, as deduced by a forwarding reference.
+        /// @param it The iterator to the element.
+        /// @return The element, as an rvalue if it may be moved from.
+        template<typename R>
+        decltype(auto) take_element(auto& it);
+    }
+
     /// @brief Base class for storage of components.
     class StorageBase {
+    protected:
+        tick_t tick_ = 0; // Current change tick, stamped on tracked components
+        std::vector<tick_t> added_ticks_; // Dense, tick each component was added at, if tracked
+        std::vector<tick_t> changed_ticks_; // Dense, tick of the last mutable access to each component, if tracked
+
     public:
         virtual ~StorageBase() = default;
 
+        /// @brief Get the current change tick of the storage.
+        /// @return The tick stamped on added and mutably accessed components.
+        [[nodiscard]] tick_t tick() const;
+
+        /// @brief Get the tick each component was added at, in dense order.
+        /// @return The added ticks, empty for untracked component types.
+        [[nodiscard]] const std::vector<tick_t>& added_ticks() const;
+
+        /// @brief Get the tick each component was last accessed mutably at, in dense order.
+        /// @return The changed ticks, empty for untracked component types.
+        [[nodiscard]] const std::vector<tick_t>& changed_ticks() const;
+
+        /// @brief Set the current change tick, forgetting removals older than the previous tick.
+        /// @param tick The new tick, usually one more than the current one.
+        virtual void set_tick(tick_t tick) = 0;
+
+        /// @brief Check if the component of an entity was added at or after a tick.
+        /// @details Always true for untracked component types, see track_changes.
+        /// @param entity_id The ID of the entity.
+        /// @param since The earliest tick to report.
+        /// @return Whether the entity has the component and it was added since the tick.
+        [[nodiscard]] virtual bool added_since(id_t entity_id, tick_t since) const = 0;
+
+        /// @brief Check if the component of an entity was added or accessed mutably at or after a tick.
+        /// @details Always true for untracked component types, see track_changes.
+        /// @param entity_id The ID of the entity.
+        /// @param since The earliest tick to report.
+        /// @return Whether the entity has the component and it changed since the tick.
+        [[nodiscard]] virtual bool changed_since(id_t entity_id, tick_t since) const = 0;
+
         /// @brief Remove an entity from the storage.
         /// This doesn't compact the storage, but marks the entity as removed.
         /// @param entity_id The ID of the entity to remove.
         virtual void remove(id_t entity_id) = 0;
 
+        /// @brief Get the number of dense slots, including removed components not yet compacted away.
+        /// @return The number of dense slots.
+        [[nodiscard]] virtual size_t size() const = 0;
+
+        /// @brief Get the number of removed components still occupying a dense slot.
+        /// @return The number of tombstones.
+        [[nodiscard]] virtual size_t tombstones() const = 0;
+
         /// @brief Compact the storage, invalidating all iterators and references.
         virtual void compact() = 0;
+
+        /// @brief Compact at most a given number of tombstones, invalidating all iterators and references.
+        /// @param budget The maximum number of tombstones to remove.
+        /// @return The number of tombstones removed.
+        virtual size_t compact(size_t budget) = 0;
     };
 
     /// @brief Storage for components of type T.
+    /// @details The entity mapping is a sparse set, the components themselves live in the pool
+    /// selected by storage_policy. Empty (tag) components store nothing but the mapping.
+    /// Components in a StablePool are never moved, so references to them survive compaction.
+    /// Tracked component types (see track_changes) also keep an added and a changed tick per dense slot,
+    /// the latter stamped by every non-const access, and a log of removals.
+    /// Adding a component for an entity that already has one replaces its value, which marks it as changed.
     /// @tparam T The type of the component to store.
     template<typename T>
     class Storage final : public StorageBase {
-        using index_t = uint16_t; // Index type for storage
+        using index_t = uint32_t; // Index type for storage
         static constexpr index_t NO_INDEX = std::numeric_limits<index_t>::max(); // Sentinel value for no index
 
-        std::vector<index_t> id_to_index_; // Sparse
-        std::vector<id_t> index_to_id_; // Dense
-        std::vector<T> storage_; // Dense
+        SparseArray<index_t, NO_INDEX> id_to_index_; // Sparse, paged, indexed by entity index
+        std::vector<id_t> index_to_id_; // Dense, full entity IDs including generation
+        pool_t<T> storage_; // Dense
+        std::vector<index_t> holes_; // Dense indices of tombstones, may contain already compacted ones
+        size_t tombstones_ = 0;
+        std::vector<std::pair<id_t, tick_t> > removed_; // Removed entities and the tick, if tracked
 
     public:
         /// @brief Storage iterator type.
@@ -41,19 +112,62 @@ namespace sim {
         explicit Storage() = default;
 
         /// @brief Get the size of the storage.
-        /// @return The number of components in the storage.
-        [[nodiscard]] size_t size() const;
+        /// @return The number of dense slots in the storage, including tombstones of removed components.
+        [[nodiscard]] size_t size() const override;
+
+        [[nodiscard]] size_t tombstones() const override;
 
         /// @brief Check if the storage contains a component for the given entity ID.
+        /// @details Stale IDs (with an outdated generation) are reported as not present.
         /// @param entity_id The ID of the entity to check.
         /// @return Whether the storage contains a component for the given entity ID.
         [[nodiscard]] bool entity_has(id_t entity_id) const;
 
+        void set_tick(tick_t tick) override;
+
+        [[nodiscard]] bool added_since(id_t entity_id, tick_t since) const override;
+
+        [[nodiscard]] bool changed_since(id_t entity_id, tick_t since) const override;
+
+        /// @brief Get the entities whose component was removed at or after a tick.
+        /// @details Removals are kept until the tick after the next one. Empty for untracked component types.
+        /// @param since The earliest tick to report, at least the previous one.
+        /// @return The IDs of the entities, in removal order. They may have been removed from the registry.
+        [[nodiscard]] std::vector<id_t> removed_since(tick_t since) const;
+
         /// @brief Get a reference to the component for the given entity ID.
-        /// @throws std::out_of_range if the entity ID is not valid.
+        /// @details A non-const access marks the component as changed.
+        /// @throws std::out_of_range if the entity ID is not valid or stale.
         /// @param id The ID of the entity to get the component for.
-        /// @return A reference to the component for the given entity ID.
-        auto&& get(this auto&& self, id_t id);
+        /// @return A reference (or a reference proxy, see reference_t) to the component for the given entity ID.
+        decltype(auto) get(this auto&& self, id_t id);
+
+        /// @brief Get the dense index of the component of an entity, without checking that it exists.
+        /// @param entity_id The ID of an entity that has the component.
+        /// @return The dense index of the component.
+        [[nodiscard]] size_t index_of(id_t entity_id) const;
+
+        /// @brief Get the component at a dense index, without any checks.
+        /// @details A non-const access marks the component as changed.
+        /// @param index The dense index of a component that was not removed.
+        /// @return A reference (or a reference proxy, see reference_t) to the component.
+        [[nodiscard]] decltype(auto) at(this auto&& self, size_t index);
+
+        /// @brief Get a column of a structure-of-arrays storage.
+        /// @details The span covers all dense slots, including removed components not yet compacted away.
+        /// A non-const access marks all the components as changed.
+        /// Use the storage iterators (entity IDs in the same order) to tell them apart.
+        /// @tparam Member Pointer to the data member whose column to get.
+        /// @return A span over the member values in dense order.
+        template<auto Member>
+        [[nodiscard]] auto column(this auto&& self) requires is_soa_v<T>;
+
+        /// @brief Get a contiguous run of components of a dense storage.
+        /// @details A non-const access marks the components of the run as changed.
+        /// @param first The dense index of the first component.
+        /// @param count The number of components.
+        /// @return A span over the components, in dense order.
+        [[nodiscard]] auto span(this auto&& self, size_t first, size_t count) requires is_dense_v<T>;
 
         /// @brief Push a component to the storage for the given entity ID.
         /// @param entity_id The ID of the entity to push the component for.
@@ -69,6 +183,28 @@ namespace sim {
         template<typename... Args>
         void emplace(id_t entity_id, Args&&... args);
 
+        /// @brief Reserve space for a number of additional components.
+        /// @param n The number of components to reserve space for, on top of the current size.
+        void reserve(size_t n);
+
+        /// @brief Emplace a component constructed from the same arguments for each of the given entity IDs.
+        /// @param entity_ids The IDs of the entities to emplace the components for.
+        /// @param args The arguments passed to every component constructor.
+        template<typename... Args>
+        void emplace_many(std::span<const id_t> entity_ids, const Args&... args);
+
+        /// @brief Push a range of components, one for each of the given entity IDs.
+        /// @throws std::invalid_argument if the number of components doesn't match the number of IDs.
+        /// @param entity_ids The IDs of the entities to push the components for.
+        /// @param components The components to push, in the same order as the IDs, moved if the range owns them.
+        template<std::ranges::sized_range R>
+        void insert(std::span<const id_t> entity_ids, R&& components);
+
+        /// @brief Push a component produced by a generator for each of the given entity IDs.
+        /// @param entity_ids The IDs of the entities to push the components for.
+        /// @param generator Called in order of the IDs, either with no arguments or with the entity ID.
+        void generate(std::span<const id_t> entity_ids, auto&& generator);
+
         void remove(id_t entity_id) override;
 
         /// @brief Remove an entity from the storage by swapping it with the last element and compacting the storage.
@@ -76,10 +212,14 @@ namespace sim {
         /// @param entity_id The ID of the entity to remove.
         void remove_unsafe(id_t entity_id);
 
-        /// @brief Call a callable on each component in the storage.
+        /// @brief Call a callable on each component in the storage, marking them as changed.
         /// @param callable The callable to call on each component.
         void for_each(auto&& callable);
 
+        /// @brief Get the entity IDs in dense order.
+        /// @return The entity ID of each dense slot, NO_ID for removed components not yet compacted away.
+        [[nodiscard]] const std::vector<id_t>& entities() const;
+
         /// @brief Get an iterator to the beginning of the storage.
         /// @return An iterator to the beginning of the storage.
         [[nodiscard]] iterator begin() const;
@@ -90,49 +230,207 @@ namespace sim {
 
         void compact() override;
 
+        size_t compact(size_t budget) override;
+
+        /// @brief Sort the components, compacting the storage first. Invalidates all iterators and references.
+        /// @param compare Comparator called either with two components or with two entity IDs.
+        void sort(auto&& compare) requires (!is_stable_v<T>);
+
+        /// @brief Sort the components by a key computed once per entity, compacting the storage first.
+        /// Invalidates all iterators and references.
+        /// @param key Called with each entity ID, returns a totally ordered key.
+        void sort_by_key(auto&& key) requires (!is_stable_v<T>);
+
+        /// @brief Arrange the components in the order of another storage, compacting this storage first.
+        /// @details Entities present in both storages come first, in the order of the other storage,
+        /// followed by the remaining ones in their current order. Invalidates all iterators and references.
+        /// @param other The storage whose order to follow. Its tombstones are skipped.
+        template<typename U>
+        void sort_as(const Storage<U>& other) requires (!is_stable_v<T>);
+
+        /// @brief Swap the components of two dense slots, either of which may hold a removed component.
+        /// @details Used by owning groups to keep their members packed. Invalidates references to both slots.
+        /// @param a The first dense index.
+        /// @param b The second dense index.
+        void swap_slots(size_t a, size_t b) requires (!is_stable_v<T>);
+
     private:
+        template<typename>
+        friend class Storage;
+
+        template<typename... Args>
+        index_t construct(Args&&... args);
+
+        template<typename... Args>
+        void assign(id_t entity_id, Args&&... args);
+
+        void apply_order(std::span<size_t> order);
         void ensure_mappings(id_t entity_id, index_t index);
+        void touch(size_t first, size_t count = 1);
+        void swap_ticks(size_t a, size_t b);
+        void tombstone(index_t index);
         void swap_remove_at(index_t index);
     };
 
     // Implementation ============================================================================
 
+    template<typename R>
+    decltype(auto) detail::take_element(auto& it) {
+        if constexpr (!std::is_lvalue_reference_v<R> && !std::ranges::view<std::remove_cvref_t<R> >)
+            return std::ranges::iter_move(it);
+        else
+            return *it;
+    }
+
+    inline tick_t StorageBase::tick() const {
+        return tick_;
+    }
+
+    inline const std::vector<tick_t>& StorageBase::added_ticks() const {
+        return added_ticks_;
+    }
+
+    inline const std::vector<tick_t>& StorageBase::changed_ticks() const {
+        return changed_ticks_;
+    }
+
     template<typename T>
     size_t Storage<T>::size() const {
-        return storage_.size();
+        return index_to_id_.size();
+    }
+
+    template<typename T>
+    size_t Storage<T>::tombstones() const {
+        return tombstones_;
     }
 
     template<typename T>
     bool Storage<T>::entity_has(const id_t entity_id) const {
-        if (entity_id >= id_to_index_.size())
-            return false;
-        return id_to_index_[entity_id] != NO_INDEX;
+        const index_t index = id_to_index_.get(to_index(entity_id));
+        return index != NO_INDEX && index_to_id_[index] == entity_id; // Generation check
+    }
+
+    template<typename T>
+    void Storage<T>::set_tick(const tick_t tick) {
+        tick_ = tick;
+        if constexpr (is_tracked_v<T>)
+            std::erase_if(removed_, [&](const auto& removal) { return removal.second + 1 < tick; });
     }
 
     template<typename T>
-    auto&& Storage<T>::get(this auto&& self, const id_t id) {
-        if (id >= self.id_to_index_.size()) // TODO: only in debug
+    bool Storage<T>::added_since(const id_t entity_id, const tick_t since) const {
+        if constexpr (is_tracked_v<T>)
+            return entity_has(entity_id) && added_ticks_[index_of(entity_id)] >= since;
+        else
+            return true;
+    }
+
+    template<typename T>
+    bool Storage<T>::changed_since(const id_t entity_id, const tick_t since) const {
+        if constexpr (is_tracked_v<T>)
+            return entity_has(entity_id) && changed_ticks_[index_of(entity_id)] >= since;
+        else
+            return true;
+    }
+
+    template<typename T>
+    std::vector<id_t> Storage<T>::removed_since(const tick_t since) const {
+        std::vector<id_t> removed;
+        for (const auto& [entity_id, tick]: removed_)
+            if (tick >= since)
+                removed.push_back(entity_id);
+        return removed;
+    }
+
+    template<typename T>
+    decltype(auto) Storage<T>::get(this auto&& self, const id_t id) {
+        if (!self.entity_has(id)) // TODO: only in debug
             throw std::out_of_range("No component for entity with this ID");
-        return self.storage_[self.id_to_index_[id]];
+        const index_t index = self.id_to_index_.get(to_index(id));
+        if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)> >)
+            self.touch(index);
+        return self.storage_[index];
+    }
+
+    template<typename T>
+    size_t Storage<T>::index_of(const id_t entity_id) const {
+        return id_to_index_.get(to_index(entity_id));
+    }
+
+    template<typename T>
+    decltype(auto) Storage<T>::at(this auto&& self, const size_t index) {
+        if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)> >)
+            self.touch(index);
+        return self.storage_[index];
+    }
+
+    template<typename T>
+    template<auto Member>
+    auto Storage<T>::column(this auto&& self) requires is_soa_v<T> {
+        if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)> >)
+            self.touch(0, self.index_to_id_.size());
+        return self.storage_.template column<Member>();
+    }
+
+    template<typename T>
+    auto Storage<T>::span(this auto&& self, const size_t first, const size_t count) requires is_dense_v<T> {
+        if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)> >)
+            self.touch(first, count);
+        return std::span(self.storage_.data() + first, count);
     }
 
     template<typename T>
     void Storage<T>::push_back(const id_t entity_id, const T& component) {
-        storage_.push_back(component);
-        ensure_mappings(entity_id, storage_.size() - 1);
+        assign(entity_id, component);
     }
 
     template<typename T>
     void Storage<T>::push_back(const id_t entity_id, T&& component) {
-        storage_.push_back(std::move(component));
-        ensure_mappings(entity_id, storage_.size() - 1);
+        assign(entity_id, std::move(component));
     }
 
     template<typename T>
     template<typename... Args>
     void Storage<T>::emplace(const id_t entity_id, Args&&... args) {
-        storage_.emplace_back(std::forward<Args>(args)...);
-        ensure_mappings(entity_id, storage_.size() - 1);
+        assign(entity_id, std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    void Storage<T>::reserve(const size_t n) {
+        storage_.reserve(index_to_id_.size() + n);
+        index_to_id_.reserve(index_to_id_.size() + n);
+    }
+
+    template<typename T>
+    template<typename... Args>
+    void Storage<T>::emplace_many(const std::span<const id_t> entity_ids, const Args&... args) {
+        reserve(entity_ids.size());
+        for (const id_t entity_id: entity_ids)
+            assign(entity_id, args...);
+    }
+
+    template<typename T>
+    template<std::ranges::sized_range R>
+    void Storage<T>::insert(const std::span<const id_t> entity_ids, R&& components) {
+        if (std::ranges::size(components) != entity_ids.size())
+            throw std::invalid_argument("Number of components doesn't match the number of entities");
+        reserve(entity_ids.size());
+        auto it = std::ranges::begin(components);
+        for (const id_t entity_id: entity_ids) {
+            assign(entity_id, detail::take_element<R>(it));
+            ++it;
+        }
+    }
+
+    template<typename T>
+    void Storage<T>::generate(const std::span<const id_t> entity_ids, auto&& generator) {
+        reserve(entity_ids.size());
+        for (const id_t entity_id: entity_ids) {
+            if constexpr (std::invocable<decltype(generator), id_t>)
+                assign(entity_id, generator(entity_id));
+            else
+                assign(entity_id, generator());
+        }
     }
 
     // Remove the entity from the storage, but do not compact it
@@ -141,33 +439,43 @@ namespace sim {
     template<typename T>
     void Storage<T>::remove(const id_t entity_id) {
         if (!entity_has(entity_id)) return; // TODO: check instead?
-        const index_t index = id_to_index_[entity_id];
-        id_to_index_[entity_id] = NO_INDEX;
-        index_to_id_[index] = NO_ID; // Mark the index as unused
+        const index_t index = id_to_index_.get(to_index(entity_id));
+        tombstone(index); // Mark the index as unused
+        if constexpr (is_stable_v<T>)
+            storage_.erase(index); // Destroy in place, the slot gets reused by the pool
+        else
+            holes_.push_back(index);
     }
 
     // Remove and compact the storage
     template<typename T>
     void Storage<T>::remove_unsafe(const id_t entity_id) {
-        const index_t index = id_to_index_[entity_id];
-        const index_t last_index = storage_.size() - 1;
-        const id_t swapped_id = index_to_id_[last_index];
-        std::swap(storage_[index], storage_[last_index]);
-        std::swap(id_to_index_[entity_id], id_to_index_[swapped_id]);
-        std::swap(index_to_id_[index], index_to_id_[last_index]);
-        storage_.pop_back();
-        index_to_id_.pop_back();
+        if constexpr (is_stable_v<T>) {
+            remove(entity_id); // Components never move
+        } else {
+            if (!entity_has(entity_id)) return;
+            const index_t index = id_to_index_.get(to_index(entity_id));
+            tombstone(index);
+            swap_remove_at(index);
+        }
     }
 
     template<typename T>
     void Storage<T>::for_each(auto&& callable) { // TODO: through ranges natively
+        touch(0, index_to_id_.size());
         for (size_t i = 0; i < storage_.size(); ++i) {
             const id_t id = index_to_id_[i];
-            T& item = storage_[i];
+            if (id == NO_ID) continue; // Removed
+            auto&& item = storage_[i];
             callable(id, item);
         }
     }
 
+    template<typename T>
+    const std::vector<id_t>& Storage<T>::entities() const {
+        return index_to_id_;
+    }
+
     template<typename T>
     typename Storage<T>::iterator Storage<T>::begin() const {
         return index_to_id_.begin();
@@ -178,29 +486,172 @@ namespace sim {
         return index_to_id_.end();
     }
 
-    // Compact the storage by removing unused indices and shifting elements
+    // Compact the storage by removing all unused indices and shifting elements
     // This invalidates all iterators and references to the storage elements
-    // It can still leave some unused indices after one sweep, if there were empty mappings at the end (TODO)
     template<typename T>
     void Storage<T>::compact() {
-        for (index_t i = 0; i < index_to_id_.size(); ++i)
-            if (index_to_id_[i] == NO_ID)
-                swap_remove_at(i);
+        compact(std::numeric_limits<size_t>::max());
+    }
+
+    // Compact up to budget tombstones, each in O(1) by swapping the last element into the hole
+    // Once the last tombstone is gone, sparse pages left without any mapping are released
+    // Pointer-stable storages are never compacted, their free slots get reused instead
+    template<typename T>
+    size_t Storage<T>::compact(const size_t budget) {
+        size_t removed = 0;
+        if constexpr (!is_stable_v<T>) {
+            while (removed < budget && !holes_.empty()) {
+                const index_t hole = holes_.back();
+                holes_.pop_back();
+                if (hole >= index_to_id_.size() || index_to_id_[hole] != NO_ID)
+                    continue; // Already compacted away or refilled
+                swap_remove_at(hole);
+                ++removed;
+            }
+            if (removed > 0 && holes_.empty())
+                id_to_index_.shrink();
+        }
+        return removed;
+    }
+
+    template<typename T>
+    void Storage<T>::sort(auto&& compare) requires (!is_stable_v<T>) {
+        compact(std::numeric_limits<size_t>::max());
+        std::vector<size_t> order(index_to_id_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::sort(order, [&](const size_t a, const size_t b) {
+            if constexpr (std::invocable<decltype(compare), const_reference_t<T>, const_reference_t<T> >)
+                return compare(std::as_const(storage_)[a], std::as_const(storage_)[b]);
+            else
+                return compare(index_to_id_[a], index_to_id_[b]);
+        });
+        apply_order(order);
+    }
+
+    template<typename T>
+    void Storage<T>::sort_by_key(auto&& key) requires (!is_stable_v<T>) {
+        compact(std::numeric_limits<size_t>::max());
+        std::vector<std::decay_t<decltype(key(id_t{}))> > keys;
+        keys.reserve(index_to_id_.size());
+        for (const id_t id: index_to_id_)
+            keys.push_back(key(id));
+
+        std::vector<size_t> order(index_to_id_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order, {}, [&](const size_t index) -> const auto& { return keys[index]; });
+        apply_order(order);
+    }
+
+    template<typename T>
+    template<typename U>
+    void Storage<T>::sort_as(const Storage<U>& other) requires (!is_stable_v<T>) {
+        // Entities missing in the other storage are keyed after all of its slots, keeping their order
+        sort_by_key([&](const id_t id) -> size_t {
+            if (other.entity_has(id))
+                return other.id_to_index_.get(to_index(id));
+            return other.size() + id_to_index_.get(to_index(id));
+        });
+    }
+
+    // A tombstone swapped to a new slot is queued again, its old entry is skipped once the slot is refilled
+    template<typename T>
+    void Storage<T>::swap_slots(const size_t a, const size_t b) requires (!is_stable_v<T>) {
+        if (a == b) return;
+        storage_.swap(a, b);
+        std::swap(index_to_id_[a], index_to_id_[b]);
+        swap_ticks(a, b);
+        for (const size_t index: {a, b}) {
+            if (index_to_id_[index] != NO_ID)
+                id_to_index_.ref(to_index(index_to_id_[index])) = static_cast<index_t>(index);
+            else
+                holes_.push_back(static_cast<index_t>(index));
+        }
+    }
+
+    // Reorder the dense arrays, order[i] being the old index of the element moved to index i
+    // Expects a compacted storage, so every slot maps to an entity
+    template<typename T>
+    void Storage<T>::apply_order(const std::span<size_t> order) {
+        detail::permute(order, [this](const size_t a, const size_t b) {
+            storage_.swap(a, b);
+            std::swap(index_to_id_[a], index_to_id_[b]);
+            swap_ticks(a, b);
+        });
+        for (index_t index = 0; index < index_to_id_.size(); ++index)
+            id_to_index_.ref(to_index(index_to_id_[index])) = index;
+    }
+
+    // Construct a component in the pool, returning its dense index
+    // Pointer-stable pools may reuse the slot of a removed component
+    template<typename T>
+    template<typename... Args>
+    typename Storage<T>::index_t Storage<T>::construct(Args&&... args) {
+        if constexpr (is_stable_v<T>) {
+            return storage_.emplace(std::forward<Args>(args)...);
+        } else {
+            storage_.emplace_back(std::forward<Args>(args)...);
+            return storage_.size() - 1;
+        }
+    }
+
+    // Replaces the component of an entity in place, or adds it if the entity has none
+    template<typename T>
+    template<typename... Args>
+    void Storage<T>::assign(const id_t entity_id, Args&&... args) {
+        if (entity_has(entity_id))
+            get(entity_id) = T(std::forward<Args>(args)...);
+        else
+            ensure_mappings(entity_id, construct(std::forward<Args>(args)...));
     }
 
     template<typename T>
     void Storage<T>::ensure_mappings(const id_t entity_id, const index_t index) {
-        if (entity_id >= id_to_index_.size())
-            id_to_index_.resize(entity_id + 1, NO_INDEX);
-        id_to_index_[entity_id] = index;
+        id_to_index_.assure(to_index(entity_id)) = index;
 
         if (index >= index_to_id_.size())
             index_to_id_.resize(index + 1, NO_ID);
+        else if (index_to_id_[index] == NO_ID)
+            --tombstones_; // Reused slot of a removed component
         index_to_id_[index] = entity_id;
+
+        if constexpr (is_tracked_v<T>) {
+            if (index >= added_ticks_.size()) {
+                added_ticks_.resize(index_to_id_.size());
+                changed_ticks_.resize(index_to_id_.size());
+            }
+            added_ticks_[index] = tick_;
+            changed_ticks_[index] = tick_;
+        }
+    }
+
+    // Stamp the current tick on a run of dense slots, if changes are tracked
+    template<typename T>
+    void Storage<T>::touch(const size_t first, const size_t count) {
+        if constexpr (is_tracked_v<T>)
+            std::fill_n(changed_ticks_.begin() + first, count, tick_);
+    }
+
+    template<typename T>
+    void Storage<T>::swap_ticks(const size_t a, const size_t b) {
+        if constexpr (is_tracked_v<T>) {
+            std::swap(added_ticks_[a], added_ticks_[b]);
+            std::swap(changed_ticks_[a], changed_ticks_[b]);
+        }
+    }
+
+    // Mark a dense index as unused and unmap its entity
+    template<typename T>
+    void Storage<T>::tombstone(const index_t index) {
+        if constexpr (is_tracked_v<T>)
+            removed_.emplace_back(index_to_id_[index], tick_);
+        id_to_index_.ref(to_index(index_to_id_[index])) = NO_INDEX;
+        index_to_id_[index] = NO_ID;
+        ++tombstones_;
     }
 
     // Remove an index from the storage by swapping it with the last element
     // The index will be overwritten, and the last element will be moved to the index
+    // If the last element was a tombstone as well, the index stays a hole and is queued again
     template<typename T>
     void Storage<T>::swap_remove_at(index_t index) {
         if (index_to_id_[index] != NO_ID)
@@ -209,13 +660,22 @@ namespace sim {
         const index_t last_index = storage_.size() - 1;
         const id_t last_id = index_to_id_[last_index];
 
-        std::swap(storage_[index], storage_[last_index]);
+        storage_.swap(index, last_index);
         std::swap(index_to_id_[index], index_to_id_[last_index]);
+        swap_ticks(index, last_index);
         if (last_id != NO_ID)
-            id_to_index_[last_id] = index; // Update the id_to_index_ mapping
+            id_to_index_.ref(to_index(last_id)) = index; // Update the id_to_index_ mapping
 
         storage_.pop_back();
         index_to_id_.pop_back();
+        if constexpr (is_tracked_v<T>) {
+            added_ticks_.pop_back();
+            changed_ticks_.pop_back();
+        }
+        --tombstones_;
+
+        if (index < index_to_id_.size() && index_to_id_[index] == NO_ID)
+            holes_.push_back(index);
     }
 }
 
@@ -0,0 +1,250 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sim {
+    /// @brief A chunk of a parallel loop, handed to the task running it.
+    struct Chunk {
+        /// @brief The position of the chunk in the loop.
+        /// @details Chunks only depend on the size of the loop and the grain size, never on the number of threads.
+        size_t index = 0;
+
+        /// @brief The first position of the chunk.
+        size_t begin = 0;
+
+        /// @brief The position past the last one of the chunk.
+        size_t end = 0;
+
+        /// @brief A random generator seeded from the seed of the loop and the index of the chunk,
+        /// so results are reproducible regardless of the number of threads and the scheduling.
+        std::mt19937_64 rng;
+    };
+
+    /// @brief A work-stealing thread pool running the chunks of parallel loops.
+    /// @details Every worker owns a queue of tasks, taking the newest from its own queue first
+    /// and stealing the oldest from the other queues when it runs dry. The thread starting a loop
+    /// runs chunks as well until the loop is done, so loops may be nested.
+    class ThreadPool {
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()> > tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue> > queues_; // One per worker, at least one
+        std::vector<std::thread> workers_;
+        std::atomic<size_t> queued_ = 0; // Tasks pushed and not taken yet, never less than the actual count
+        std::atomic<size_t> next_queue_ = 0; // Round-robin queue for new tasks
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+        bool stop_ = false;
+
+    public:
+        /// @brief Default number of elements per chunk of a parallel loop.
+        static constexpr size_t DEFAULT_GRAIN = 1024;
+
+        /// @brief Starts a pool with a number of worker threads.
+        /// @param threads The number of worker threads. With none, loops run on the calling thread only.
+        explicit ThreadPool(size_t threads = default_threads());
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// @brief Stops and joins the worker threads.
+        ~ThreadPool();
+
+        /// @brief Get the default number of worker threads, one less than the hardware threads,
+        /// as the thread starting a loop takes part in it.
+        /// @return The default number of worker threads.
+        [[nodiscard]] static size_t default_threads();
+
+        /// @brief Get the number of worker threads.
+        /// @return The number of worker threads.
+        [[nodiscard]] size_t size() const;
+
+        /// @brief Get the index of the calling thread within the pool, e.g. to give each thread its own buffer.
+        /// @return i + 1 for the i-th worker of this pool, 0 for any other thread (such as the one starting loops).
+        [[nodiscard]] size_t thread_index() const;
+
+        /// @brief Runs a task for every chunk of the range [0, count), returning once all of them are done.
+        /// @details The task is called concurrently from several threads, once per chunk.
+        /// @throws Rethrows the first exception thrown by a task, after all the chunks are done.
+        /// @param count The number of elements.
+        /// @param grain The number of elements per chunk, the last chunk may be smaller.
+        /// @param seed The seed from which the random generator of every chunk is derived.
+        /// @param task Called with a reference to each Chunk.
+        void parallel_for(size_t count, size_t grain, uint64_t seed, auto&& task);
+
+    private:
+        // Pushes a task without waking any worker
+        void push(std::function<void()> task);
+
+        // Runs one task, from the home queue if possible, returning whether there was any
+        bool try_run(size_t home);
+
+        void work(size_t index);
+    };
+
+    namespace detail {
+        /// @brief Mixes a seed with an index (splitmix64), so neighbouring indices give unrelated seeds.
+        /// @param seed The base seed.
+        /// @param index The index to mix in.
+        /// @return The mixed seed.
+        [[nodiscard]] constexpr uint64_t mix_seed(uint64_t seed, uint64_t index);
+
+        inline thread_local const ThreadPool* current_pool = nullptr; // Pool the calling thread works for, if any
+        inline thread_local size_t current_worker = 0; // Index of the calling thread in current_pool, plus one
+
+        // Position of the calling thread in the work as if every loop ran its chunks one after another:
+        // for each enclosing chunk, the step at which its loop started followed by the index of the chunk.
+        // Orders the commands recorded by concurrent chunks regardless of the scheduling, see BasicCommandBuffer.
+        inline thread_local std::vector<uint64_t> current_path;
+        inline thread_local uint64_t current_step = 0; // Steps (loops started, commands recorded) taken in the chunk
+    }
+
+    // Implementation ============================================================================
+
+    inline ThreadPool::ThreadPool(const size_t threads) {
+        for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i)
+            queues_.push_back(std::make_unique<Queue>());
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+            workers_.emplace_back([this, i] { work(i); });
+    }
+
+    inline ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker: workers_)
+            worker.join();
+    }
+
+    inline size_t ThreadPool::default_threads() {
+        const size_t hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    inline size_t ThreadPool::size() const {
+        return workers_.size();
+    }
+
+    void ThreadPool::parallel_for(const size_t count, size_t grain, const uint64_t seed, auto&& task) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+        const size_t chunks = (count + grain - 1) / grain;
+
+        std::vector<uint64_t> loop_path = detail::current_path;
+        loop_path.push_back(detail::current_step++);
+
+        std::atomic<size_t> remaining = chunks;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        const auto run_chunk = [&](const size_t index) {
+            {
+                std::vector<uint64_t> path = loop_path;
+                path.push_back(index);
+                std::swap(path, detail::current_path); // The thread may be helping from within another chunk
+                const uint64_t step = std::exchange(detail::current_step, 0);
+
+                const size_t begin = index * grain;
+                Chunk chunk{index, begin, std::min(count, begin + grain), std::mt19937_64(detail::mix_seed(seed, index))};
+                try {
+                    task(chunk);
+                } catch (...) {
+                    std::lock_guard lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+
+                std::swap(path, detail::current_path);
+                detail::current_step = step;
+            }
+            remaining.fetch_sub(1, std::memory_order_release); // Last access to the loop state
+        };
+
+        if (workers_.empty() || chunks == 1) {
+            for (size_t index = 0; index < chunks; ++index)
+                run_chunk(index);
+        } else {
+            for (size_t index = 1; index < chunks; ++index)
+                push([&run_chunk, index] { run_chunk(index); });
+            {
+                std::lock_guard lock(sleep_mutex_);
+            }
+            wake_.notify_all();
+
+            run_chunk(0);
+            while (remaining.load(std::memory_order_acquire) > 0)
+                if (!try_run(0)) // Help with any queued task, possibly of another loop
+                    std::this_thread::yield();
+        }
+
+        if (error) std::rethrow_exception(error);
+    }
+
+    inline size_t ThreadPool::thread_index() const {
+        return detail::current_pool == this ? detail::current_worker : 0;
+    }
+
+    inline void ThreadPool::push(std::function<void()> task) {
+        Queue& queue = *queues_[next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size()];
+        queued_.fetch_add(1);
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    inline bool ThreadPool::try_run(const size_t home) {
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            Queue& queue = *queues_[(home + i) % queues_.size()];
+            std::function<void()> task;
+            {
+                std::lock_guard lock(queue.mutex);
+                if (queue.tasks.empty()) continue;
+                if (i == 0) { // Newest of the own queue, still warm in the cache
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                } else { // Oldest of another queue
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+            }
+            queued_.fetch_sub(1);
+            task();
+            return true;
+        }
+        return false;
+    }
+
+    inline void ThreadPool::work(const size_t index) {
+        detail::current_pool = this;
+        detail::current_worker = index + 1;
+        while (true) {
+            if (try_run(index)) continue;
+            std::unique_lock lock(sleep_mutex_);
+            wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            if (stop_) return; // Loops wait for their chunks, so no task is left behind
+        }
+    }
+
+    constexpr uint64_t detail::mix_seed(const uint64_t seed, const uint64_t index) {
+        uint64_t z = seed + (index + 1) * 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+}
+
+#endif //THREAD_POOL_H
@@ -44,6 +44,28 @@ namespace sim {
 
     template<typename... Ts>
     using first_t = std::tuple_element_t<0, std::tuple<Ts...> >;
+
+    template<typename MemberPtr>
+    struct member_pointer_traits {
+        static_assert(sizeof(MemberPtr) && false, "Not a pointer to data member.");
+    };
+
+    template<typename Class, typename Value>
+    struct member_pointer_traits<Value Class::*> {
+        using class_t = Class;
+        using value_t = Value;
+    };
+
+    template<auto A, auto B>
+    constexpr bool is_same_member_v = [] {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>)
+            return A == B;
+        else
+            return false;
+    }();
+
+    template<auto Member>
+    using member_value_t = typename member_pointer_traits<decltype(Member)>::value_t;
 }
 
 #endif //TRAITS_H
@@ -0,0 +1,67 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace sim {
+    /// @brief Hands the latest value from one writer thread to one reader thread, without locking or waiting.
+    /// @details Holds three slots: the writer fills the back one and publishes it by swapping it with the middle one,
+    /// the reader takes the middle one by swapping it with its front one. Neither ever waits for the other,
+    /// the writer overwrites values the reader skipped, and the reader keeps its value until a newer one is published.
+    /// Slots are reused, so values holding memory (e.g. vectors) keep their capacity.
+    /// @tparam T The value type.
+    template<typename T>
+    class TripleBuffer {
+        static constexpr uint8_t INDEX_MASK = 0b011;
+        static constexpr uint8_t FRESH = 0b100; // Set while the middle slot holds a value the reader hasn't taken
+
+        std::array<T, 3> slots_{};
+        std::atomic<uint8_t> middle_ = 1;
+        uint8_t back_ = 0; // Only used by the writer
+        uint8_t front_ = 2; // Only used by the reader
+
+    public:
+        /// @brief Get the slot the writer fills. Only the writer may call this.
+        /// @return A reference to the back slot, holding a value published before (or a default one).
+        [[nodiscard]] T& back();
+
+        /// @brief Publishes the back slot, making it the latest value, and takes over another slot.
+        /// Only the writer may call this.
+        void publish();
+
+        /// @brief Takes the latest published value if there is a new one. Only the reader may call this.
+        /// @return Whether front() changed.
+        bool refresh();
+
+        /// @brief Get the value the reader took last. Only the reader may call this.
+        /// @return A reference to the front slot.
+        [[nodiscard]] const T& front() const;
+    };
+
+    // Implementation ============================================================================
+
+    template<typename T>
+    T& TripleBuffer<T>::back() {
+        return slots_[back_];
+    }
+
+    template<typename T>
+    void TripleBuffer<T>::publish() {
+        back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    template<typename T>
+    bool TripleBuffer<T>::refresh() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    template<typename T>
+    const T& TripleBuffer<T>::front() const {
+        return slots_[front_];
+    }
+}
+
+#endif //TRIPLE_BUFFER_H
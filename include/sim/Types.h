@@ -1,12 +1,56 @@
 #ifndef TYPES_H
 #define TYPES_H
+#include <cstdint>
+#include <limits>
 
 namespace sim {
-    /// @brief Entity ID type
-    using id_t = uint16_t;
+#ifdef SIM_WIDE_ENTITY_IDS
+    /// @brief Entity ID type. A handle packing an entity index (low bits) and a generation (high bits).
+    using id_t = uint64_t;
+
+    /// @brief Number of low bits of an entity ID used for the entity index.
+    constexpr unsigned ENTITY_INDEX_BITS = 32;
+#else
+    /// @brief Entity ID type. A handle packing an entity index (low bits) and a generation (high bits).
+    using id_t = uint32_t;
+
+    /// @brief Number of low bits of an entity ID used for the entity index.
+    constexpr unsigned ENTITY_INDEX_BITS = 22;
+#endif
+
+    /// @brief Mask selecting the entity index part of an entity ID.
+    constexpr id_t ENTITY_INDEX_MASK = (id_t{1} << ENTITY_INDEX_BITS) - 1;
+
+    /// @brief Maximum number of simultaneously addressable entities. The all-ones index is reserved for NO_ID.
+    constexpr id_t MAX_ENTITIES = ENTITY_INDEX_MASK;
 
     /// @brief Sentinel value for no ID
     constexpr id_t NO_ID = std::numeric_limits<id_t>::max();
+
+    /// @brief Change tick type, see track_changes. The registry advances it once per simulation cycle.
+    using tick_t = uint32_t;
+
+    /// @brief Extracts the entity index from an entity ID.
+    /// @param id The entity ID.
+    /// @return The index part of the ID, usable for indexing sparse arrays.
+    constexpr id_t to_index(const id_t id) {
+        return id & ENTITY_INDEX_MASK;
+    }
+
+    /// @brief Extracts the generation from an entity ID.
+    /// @param id The entity ID.
+    /// @return The generation part of the ID.
+    constexpr id_t to_generation(const id_t id) {
+        return id >> ENTITY_INDEX_BITS;
+    }
+
+    /// @brief Composes an entity ID from an index and a generation.
+    /// @param index The entity index.
+    /// @param generation The generation of the index.
+    /// @return The entity ID.
+    constexpr id_t make_id(const id_t index, const id_t generation) {
+        return (generation << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+    }
 }
 
 #endif //TYPES_H
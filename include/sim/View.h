@@ -1,39 +1,129 @@
 #ifndef VIEW_H
 #define VIEW_H
 
+#include "Commands.h"
+#include "Concepts.h"
+#include "Group.h"
 #include "Registry.h"
+#include "ThreadPool.h"
 #include "Traits.h"
 
 namespace sim {
     /// @brief A lightweight view of entities with specific components.
+    /// @details Iteration is driven by the storage with the fewest live components at construction,
+    /// so the cost of a view is proportional to its rarest component.
+    /// Entities having any excluded component are skipped by a single signature check.
+    /// Added and changed filters are checked against the change ticks of their storages, after all the others.
+    /// Components of tracked types accessed through a mutable view are marked as changed, see track_changes,
+    /// unless requested as const, e.g. `view<const Transform, Target>()`: those are only handed out read-only.
+    /// @tparam Reg The registry type managing the entities.
     /// @tparam Imm Whether the view is immutable (true) or mutable (false).
-    /// @tparam Cs The component types to include in the view.
-    template<bool Imm, typename... Cs>
-    class View {
+    /// @tparam Os The optional component types, see optional_t.
+    /// @tparam Cs The component types to include in the view, const qualified to only read them.
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    class BasicView<Reg, Imm, optional_t<Os...>, Cs...> {
         template<typename C>
-        using storage_t = std::conditional_t<Imm, const Storage<C>, Storage<C> >;
+        using storage_t = std::conditional_t<Imm || std::is_const_v<C>, const Storage<std::remove_const_t<C> >,
+            Storage<std::remove_const_t<C> > >;
+        using entity_type = typename Reg::entity_type;
+        using const_entity_type = typename Reg::const_entity_type;
 
         const std::tuple<storage_t<Cs>*...> storages_;
-        Registry* registry_;
+        const std::tuple<storage_t<Os>*...> optional_storages_;
+        const Signature excluded_; // Entities with any of these components are skipped
+        const bool has_excluded_;
+        const StorageBase* driver_ = nullptr; // The smallest storage, driving the iteration
+        const std::vector<id_t>* entities_ = nullptr; // Dense entities of the driving storage
+        Reg* registry_;
+        std::vector<detail::TickFilter> tick_filters_;
+        tick_t since_ = 0; // Earliest change tick passing the filters
 
     public:
         /// @brief Constructs a view with the given storages and registry.
         /// @param storages The storages containing the components of the view.
         /// @param registry A pointer to the registry managing the entities.
-        explicit View(storage_t<Cs>*... storages, Registry* registry);
+        /// @param excluded The components whose owners are skipped.
+        /// @param optional_storages The storages containing the optional components of the view.
+        /// @param tick_filters The added and changed filters, passing changes since the previous tick of the registry.
+        explicit BasicView(storage_t<Cs>*... storages, Reg* registry, const Signature& excluded = {},
+                      std::tuple<storage_t<Os>*...> optional_storages = {},
+                      std::vector<detail::TickFilter> tick_filters = {});
 
         /// @brief Calls the given callable for each entity in the view.
-        /// @details The callable should accept all the components in the view as references to const.
+        /// @details The callable should accept all the components in the view as references to const,
+        /// followed by a pointer to const for each optional component, null if the entity doesn't have it.
         /// It can also optionally accept the entity itself as the first argument.
         /// @param callable The callable to call for each entity.
         void for_each(auto&& callable) const;
 
         /// @brief Calls the given callable for each entity in the view.
-        /// @details The callable should accept all the components in the view as arguments, and can modify them.
+        /// @details The callable should accept all the components in the view as arguments, and can modify those
+        /// not requested as const, followed by a pointer for each optional component, null if the entity doesn't have it.
         /// It can also optionally accept the entity itself as the first argument.
         /// @param callable The callable to call for each entity.
         void for_each(auto&& callable) requires (!Imm);
 
+        /// @brief Calls the given callable for each entity in the view, in parallel on a thread pool.
+        /// @details The dense range of the driving storage is split into chunks of the grain size, run as tasks
+        /// of the pool. The callable accepts the same arguments as for for_each(), optionally preceded
+        /// by a reference to the Chunk being run, whose random generator is seeded deterministically.
+        /// The callable is called concurrently: it may only modify the components it is given,
+        /// and must not add or remove any components or entities.
+        /// @param pool The thread pool running the chunks.
+        /// @param callable The callable to call for each entity.
+        /// @param grain The number of dense slots of the driving storage per chunk.
+        /// @param seed The seed from which the random generator of every chunk is derived.
+        void par_for_each(ThreadPool& pool, auto&& callable, size_t grain = ThreadPool::DEFAULT_GRAIN,
+                          uint64_t seed = 0) const;
+
+        /// @brief Calls the given callable for each entity in the view, in parallel on a thread pool.
+        /// @details Like the const overload, but the callable can modify the components.
+        /// @param pool The thread pool running the chunks.
+        /// @param callable The callable to call for each entity.
+        /// @param grain The number of dense slots of the driving storage per chunk.
+        /// @param seed The seed from which the random generator of every chunk is derived.
+        void par_for_each(ThreadPool& pool, auto&& callable, size_t grain = ThreadPool::DEFAULT_GRAIN,
+                          uint64_t seed = 0) requires (!Imm);
+
+        /// @brief Calls the given callable for each contiguous run of entities in the view.
+        /// @details A run is a sequence of entities whose components are adjacent in every storage of the view,
+        /// e.g. the members of a group or entities of storages sorted alike. The callable should accept
+        /// a span of const components per component type, and can optionally accept the span of entity IDs first.
+        /// Tight loops over the spans can be vectorized by the compiler.
+        /// The callable must not add or remove components of the types in the view.
+        /// @param callable The callable to call for each run.
+        /// @param max_size The maximal number of entities per run, e.g. to split the work into tasks.
+        void each_chunk(auto&& callable, size_t max_size = std::numeric_limits<size_t>::max()) const;
+
+        /// @brief Calls the given callable for each contiguous run of entities in the view.
+        /// @details Like the const overload, but the callable receives mutable spans of the components
+        /// not requested as const.
+        /// @param callable The callable to call for each run.
+        /// @param max_size The maximal number of entities per run, e.g. to split the work into tasks.
+        void each_chunk(auto&& callable, size_t max_size = std::numeric_limits<size_t>::max()) requires (!Imm);
+
+        /// @brief Collects the entities of the view into a vector, a sized, random-access range.
+        /// @details Membership is checked once per entity here rather than on every pass, so the result suits
+        /// repeated scans such as closest entity searches, and can be split by index, e.g. by std::execution
+        /// algorithms or ThreadPool::parallel_for(). It is a snapshot: entities gaining or losing components
+        /// afterward are not reflected, and removed entities are left dangling.
+        /// @return Const handles to the entities, in the order of the view iterators.
+        [[nodiscard]] std::vector<const_entity_type> collect() const;
+
+        /// @brief Collects the entities of the view into a vector, a sized, random-access range.
+        /// @details Like the const overload, but the handles can modify the entities.
+        /// @return Handles to the entities, in the order of the view iterators.
+        [[nodiscard]] std::vector<entity_type> collect() requires (!Imm);
+
+        /// @brief Gets a member column of a single-component view over a structure-of-arrays storage.
+        /// @details The span covers every dense slot of the storage, in the same order as the view iterators,
+        /// including removed components that were not compacted away yet.
+        /// Tight loops over columns can be vectorized by the compiler.
+        /// @tparam Member Pointer to the data member whose column to get.
+        /// @return A span over the member values.
+        template<auto Member>
+        [[nodiscard]] auto column() const requires (sizeof...(Cs) == 1 && (is_soa_v<std::remove_const_t<Cs> > && ...));
+
         /// @brief Checks if the view is empty.
         /// @return Whether the view contains any entities.
         [[nodiscard]] bool empty() const;
@@ -64,37 +154,60 @@ namespace sim {
         /// @brief Returns a mutable iterator to the end of the view.
         /// @return A mutable iterator to the end of the view.
         [[nodiscard]] iterator end() requires (!Imm);
+
+    private:
+        // Checks if the entity at a position of the driving storage has all the other components and passes the filters
+        [[nodiscard]] bool contains(size_t pos) const;
+
+        // Checks the change filters, by dense position for the driving storage
+        [[nodiscard]] bool passes_tick_filters(size_t pos, id_t entity_id) const;
+
+        template<bool Const>
+        void for_each_impl(auto&& callable) const;
+
+        template<bool Const>
+        void par_for_each_impl(ThreadPool& pool, auto&& callable, size_t grain, uint64_t seed) const;
+
+        // Calls the callable for the entity at a position of the driving storage, after the leading arguments
+        template<bool Const>
+        void visit(size_t pos, auto&& callable, auto&... leading) const;
+
+        template<bool Const>
+        void each_chunk_impl(auto&& callable, size_t max_size) const;
+
+        template<bool Const>
+        auto collect_impl() const;
     };
 
     /// @brief View iterator base class.
+    /// @tparam Reg The registry type managing the entities.
     /// @tparam Imm Whether the view is immutable (true) or mutable (false).
     /// @tparam Cs The component types in the view.
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    struct View<Imm, Cs...>::iterator_base {
+    struct BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base {
     private:
-        using entity_t = std::conditional_t<Const, ConstEntity, Entity>;
+        using entity_t = std::conditional_t<Const, const_entity_type, entity_type>;
 
     public:
         using value_type = entity_t;
         using reference = entity_t;
         using difference_type = std::ptrdiff_t;
-        using iterator_category = std::input_iterator_tag;
-        using iterator_concept = std::input_iterator_tag;
+        using iterator_category = std::input_iterator_tag; // Dereferencing yields handles by value
+        using iterator_concept = std::forward_iterator_tag;
 
     private:
-        using view_t = std::conditional_t<Const, const View, View>;
-        using it_t = typename Storage<first_t<Cs...> >::iterator;
+        using view_t = std::conditional_t<Const, const BasicView, BasicView>;
 
-        view_t* view_;
-        it_t it_;
+        view_t* view_ = nullptr;
+        size_t pos_ = 0; // Dense position in the driving storage
 
     public:
         /// @brief The default constructor creates an invalid iterator.
         iterator_base() = default;
 
-        /// @brief Constructs an iterator for the given view and storage iterator.
-        explicit iterator_base(view_t* view, typename Storage<first_t<Cs...> >::iterator it);
+        /// @brief Constructs an iterator for the given view at a dense position of its driving storage.
+        explicit iterator_base(view_t* view, size_t pos);
 
         /// @brief Checks if this iterator is equal to another iterator.
         /// @param other The other iterator to compare with.
@@ -119,18 +232,36 @@ namespace sim {
     };
 
     /// @brief Provides the context of the current simulation cycle and allows access to entities and views.
-    class Context {
+    /// @tparam Reg The registry type holding the entities and components.
+    template<typename Reg>
+    class BasicContext {
         const size_t cycle_ = 0;
-        Registry* registry_;
+        Reg* registry_;
+        ThreadPool* pool_; // Runs parallel loops, on the calling thread if null
+        BasicCommandBuffer<Reg>* commands_; // Records structural changes, applied by the simulation
 
     public:
-        /// @brief Constructs a context for the given registry and cycle.
-        explicit Context(Registry* registry, size_t cycle);
+        /// @brief The mutable entity handle type.
+        using entity_type = typename Reg::entity_type;
+
+        /// @brief The immutable entity handle type.
+        using const_entity_type = typename Reg::const_entity_type;
 
-        Context(const Context&) = default;
-        Context(Context&&) = default;
-        Context& operator=(const Context&) = delete;
-        Context& operator=(Context&&) = delete;
+        /// @brief The registry type holding the entities.
+        using registry_type = Reg;
+
+        /// @brief Constructs a context for the given registry and cycle.
+        /// @param registry The registry holding the entities.
+        /// @param cycle The current cycle.
+        /// @param pool The thread pool running parallel loops. Without one, they run on the calling thread.
+        /// @param commands The command buffer handed out by commands(), applied by the owner of the context.
+        explicit BasicContext(Reg* registry, size_t cycle, ThreadPool* pool = nullptr,
+                              BasicCommandBuffer<Reg>* commands = nullptr);
+
+        BasicContext(const BasicContext&) = default;
+        BasicContext(BasicContext&&) = default;
+        BasicContext& operator=(const BasicContext&) = delete;
+        BasicContext& operator=(BasicContext&&) = delete;
 
         /// @brief Returns the current simulation cycle.
         /// @return The current cycle number.
@@ -138,161 +269,466 @@ namespace sim {
 
         /// @brief Returns an immutable view of entities with the specified components.
         /// @tparam Cs The component types to include in the view.
+        /// @param filters Optional exclude, optional, added and changed filters,
+        /// e.g. `view<Transform>(changed<Transform>)`.
         /// @return An immutable view of entities with the specified components.
-        template<typename... Cs>
-        [[nodiscard]] ImmutableView<Cs...> view() const;
+        template<typename... Cs, typename... Fs>
+        [[nodiscard]] auto view(Fs... filters) const;
 
         /// @brief Returns a mutable view of entities with the specified components.
+        /// @details Accessing tracked components through it marks them as changed, so systems that only read
+        /// should prefer the immutable view.
         /// @tparam Cs The component types to include in the view.
+        /// @param filters Optional exclude, optional, added and changed filters,
+        /// e.g. `view<Transform>(changed<Transform>)`.
         /// @return A mutable view of entities with the specified components.
+        template<typename... Cs, typename... Fs>
+        [[nodiscard]] auto view(Fs... filters);
+
+        /// @brief Returns the owning group of a set of components, creating it on first use.
+        /// @details See Registry::group(). Backends without groups return a mutable view instead.
+        /// @tparam Cs The component types to own.
+        /// @return The group (or view) of entities with the specified components.
         template<typename... Cs>
-        [[nodiscard]] MutableView<Cs...> view();
+        [[nodiscard]] decltype(auto) group();
+
+        /// @brief Calls the given callable for each entity with the specified components, in parallel.
+        /// @details Runs on the thread pool of the simulation, see View::par_for_each() for the accepted callables
+        /// and their restrictions. The random generators of the chunks are seeded from the cycle,
+        /// so runs are reproducible for a given grain size.
+        /// @tparam Cs The component types of the entities to visit.
+        /// @param callable The callable to call for each entity.
+        /// @param grain The number of entities per chunk.
+        template<typename... Cs>
+        void par_for_each(auto&& callable, size_t grain = ThreadPool::DEFAULT_GRAIN);
+
+        /// @brief Gets the entities whose component of a type was removed since the previous cycle.
+        /// @details See Registry::removed().
+        /// @tparam C The component type, whose changes must be tracked, see track_changes.
+        /// @return The IDs of the entities. They may have been removed from the registry.
+        template<typename C>
+        [[nodiscard]] std::vector<id_t> removed() const;
 
         /// @brief Gets an immutable Entity handle by its ID.
         /// @param entity_id The ID of the entity to retrieve.
         /// @return A ConstEntity with the specified ID.
-        [[nodiscard]] ConstEntity get_entity(id_t entity_id) const;
+        [[nodiscard]] const_entity_type get_entity(id_t entity_id) const;
 
         /// @brief Gets a mutable Entity handle by its ID.
         /// @param entity_id The ID of the entity to retrieve.
         /// @return An Entity with the specified ID.
-        [[nodiscard]] Entity get_entity(id_t entity_id);
+        [[nodiscard]] entity_type get_entity(id_t entity_id);
+
+        /// @brief Creates a new entity in the registry.
+        /// @return A handle to the new entity.
+        entity_type create_entity();
 
         /// @brief Removes an entity from the registry.
-        void remove_entity(ConstEntity entity);
+        void remove_entity(const_entity_type entity);
 
         /// @brief Removes an entity from the registry by its ID.
         void remove_entity(id_t entity_id);
+
+        /// @brief Gets the command buffer recording structural changes, applied at the end of the current event.
+        /// @details Systems iterating views, systems running concurrently and par_for_each() callables
+        /// must not create or remove entities and components directly, but can record it here,
+        /// e.g. `ctx.commands().destroy(entity)`. See BasicCommandBuffer for the order in which they are applied.
+        /// @throws std::logic_error if the context was constructed without a command buffer.
+        /// @return The command buffer.
+        [[nodiscard]] BasicCommandBuffer<Reg>& commands() const;
+
+        /// @brief Sorts the components of a type by a key, arranging other component types in the same order.
+        /// @details See Registry::sort_by(). Invalidates all views and references obtained before.
+        /// @tparam C The component type the key is computed from.
+        /// @tparam Others The component types that follow the order of C.
+        /// @param key Called with each component of type C, returns a totally ordered key.
+        template<typename C, typename... Others>
+        void sort_by(auto&& key);
     };
 
+    /// @brief The context of the default, sparse set based registry.
+    using Context = BasicContext<Registry>;
+
     // Implementation ============================================================================
 
-    template<bool Imm, typename... Cs>
-    View<Imm, Cs...>::View(storage_t<Cs>*... storages, Registry* registry):
-        storages_(storages...), registry_(registry) {}
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::BasicView(storage_t<Cs>*... storages, Reg* registry,
+                                                             const Signature& excluded,
+                                                             std::tuple<storage_t<Os>*...> optional_storages,
+                                                             std::vector<detail::TickFilter> tick_filters):
+        storages_(storages...), optional_storages_(optional_storages), excluded_(excluded),
+        has_excluded_(excluded != Signature{}), registry_(registry), tick_filters_(std::move(tick_filters)),
+        since_(registry->tick() > 0 ? registry->tick() - 1 : 0) {
+        size_t smallest = std::numeric_limits<size_t>::max();
+        ([&](const auto* storage) {
+            const size_t live = storage->size() - storage->tombstones();
+            if (live < smallest) {
+                smallest = live;
+                driver_ = storage;
+                entities_ = &storage->entities();
+            }
+        }(storages), ...);
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::for_each(auto&& callable) const {
+        for_each_impl<true>(std::forward<decltype(callable)>(callable));
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::for_each(auto&& callable) requires (!Imm) {
+        for_each_impl<false>(std::forward<decltype(callable)>(callable));
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::par_for_each(ThreadPool& pool, auto&& callable,
+                                                                     const size_t grain, const uint64_t seed) const {
+        par_for_each_impl<true>(pool, std::forward<decltype(callable)>(callable), grain, seed);
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::par_for_each(ThreadPool& pool, auto&& callable,
+                                                                     const size_t grain,
+                                                                     const uint64_t seed) requires (!Imm) {
+        par_for_each_impl<false>(pool, std::forward<decltype(callable)>(callable), grain, seed);
+    }
+
+    // Iterates positions rather than iterators, so the callable may add components to the driving storage
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::for_each_impl(auto&& callable) const {
+        const std::vector<id_t>& entities = *entities_;
+        for (size_t pos = 0; pos < entities.size(); ++pos)
+            if (contains(pos))
+                visit<Const>(pos, callable);
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::par_for_each_impl(ThreadPool& pool, auto&& callable,
+                                                                          const size_t grain, const uint64_t seed) const {
+        const std::vector<id_t>& entities = *entities_;
+        pool.parallel_for(entities.size(), grain, seed, [&](Chunk& chunk) {
+            for (size_t pos = chunk.begin; pos < chunk.end; ++pos)
+                if (contains(pos))
+                    visit<Const>(pos, callable, chunk);
+        });
+    }
 
-    template<bool Imm, typename... Cs>
-    void View<Imm, Cs...>::for_each(auto&& callable) const {
-        for (ConstEntity entity: *this) {
-            if constexpr (requires { std::forward<decltype(callable)>(callable)(entity, entity.get<Cs>()...); })
-                std::forward<decltype(callable)>(callable)(entity, entity.get<Cs>()...);
+    // Resolves components straight from the held storages: the driving one by the dense position,
+    // the others by a single sparse lookup, as membership was already checked.
+    // The entity is preferred over the leading arguments, so a generic first parameter always gets the entity.
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::visit(const size_t pos, auto&& callable,
+                                                              auto&... leading) const {
+        using entity_t = std::conditional_t<Const, const_entity_type, entity_type>;
+
+        const id_t entity_id = (*entities_)[pos];
+        const auto component = [&]<typename C>(std::type_identity<C>) -> decltype(auto) {
+            auto* storage = std::get<storage_t<C>*>(storages_);
+            const size_t index = storage == driver_ ? pos : storage->index_of(entity_id);
+            if constexpr (Const)
+                return std::as_const(*storage).at(index);
             else
-                std::apply(std::forward<decltype(callable)>(callable), entity.get_all<Cs...>());
-        }
+                return storage->at(index);
+        };
+        const auto optional = [&]<typename O>(std::type_identity<O>) {
+            auto* storage = std::get<storage_t<O>*>(optional_storages_);
+            using pointer_t = std::conditional_t<Const, const O*, O*>;
+            if (!storage || !storage->entity_has(entity_id)) // Immutable views may lack the storage
+                return pointer_t{nullptr};
+            if constexpr (Const)
+                return &std::as_const(*storage).at(storage->index_of(entity_id));
+            else
+                return &storage->at(storage->index_of(entity_id));
+        };
+
+        entity_t entity(entity_id, registry_);
+        if constexpr (requires {
+            callable(leading..., entity, component(std::type_identity<Cs>{})...,
+                     optional(std::type_identity<Os>{})...);
+        })
+            callable(leading..., entity, component(std::type_identity<Cs>{})...,
+                     optional(std::type_identity<Os>{})...);
+        else if constexpr (requires {
+            callable(entity, component(std::type_identity<Cs>{})..., optional(std::type_identity<Os>{})...);
+        })
+            callable(entity, component(std::type_identity<Cs>{})..., optional(std::type_identity<Os>{})...);
+        else if constexpr (requires {
+            callable(leading..., component(std::type_identity<Cs>{})..., optional(std::type_identity<Os>{})...);
+        })
+            callable(leading..., component(std::type_identity<Cs>{})..., optional(std::type_identity<Os>{})...);
+        else
+            callable(component(std::type_identity<Cs>{})..., optional(std::type_identity<Os>{})...);
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::each_chunk(auto&& callable, const size_t max_size) const {
+        each_chunk_impl<true>(std::forward<decltype(callable)>(callable), max_size);
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::each_chunk(auto&& callable,
+                                                                   const size_t max_size) requires (!Imm) {
+        each_chunk_impl<false>(std::forward<decltype(callable)>(callable), max_size);
     }
 
-    template<bool Imm, typename... Cs>
-    void View<Imm, Cs...>::for_each(auto&& callable) requires (!Imm) {
-        for (Entity entity: *this) {
-            if constexpr (requires { callable(entity, entity.get<Cs>()...); })
-                std::forward<decltype(callable)>(callable)(entity, entity.get<Cs>()...);
+    // Starts a run at each entity of the view and extends it while the next entity of the driving storage
+    // is in the view and sits right after the previous one in every other storage
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::each_chunk_impl(auto&& callable, const size_t max_size) const {
+        static_assert(sizeof...(Os) == 0, "Chunks can't hold optional components");
+        static_assert((is_dense_v<std::remove_const_t<Cs> > && ...), "Chunks need all components stored in a DensePool");
+
+        const std::vector<id_t>& entities = *entities_;
+        const auto index = [&](const auto* storage, const size_t pos) -> size_t {
+            return storage == driver_ ? pos : storage->index_of(entities[pos]);
+        };
+        const auto run = [&]<size_t... I>(const size_t pos, std::index_sequence<I...>) {
+            const std::array<size_t, sizeof...(Cs)> first{index(std::get<I>(storages_), pos)...};
+            size_t length = 1;
+            while (length < max_size && pos + length < entities.size() && contains(pos + length)
+                   && ((index(std::get<I>(storages_), pos + length) == first[I] + length) && ...))
+                ++length;
+
+            const auto chunk = [&](auto* storage, const size_t begin) {
+                if constexpr (Const)
+                    return std::as_const(*storage).span(begin, length);
+                else
+                    return storage->span(begin, length);
+            };
+            const std::span<const id_t> ids(entities.data() + pos, length);
+            if constexpr (requires { callable(ids, chunk(std::get<I>(storages_), first[I])...); })
+                callable(ids, chunk(std::get<I>(storages_), first[I])...);
+            else
+                callable(chunk(std::get<I>(storages_), first[I])...);
+            return length;
+        };
+
+        for (size_t pos = 0; pos < entities.size();) {
+            if (contains(pos))
+                pos += run(pos, std::index_sequence_for<Cs...>{});
             else
-                std::apply(std::forward<decltype(callable)>(callable), entity.get_all<Cs...>());
+                ++pos;
         }
     }
 
-    template<bool Imm, typename... Cs>
-    bool View<Imm, Cs...>::empty() const {
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    std::vector<typename Reg::const_entity_type> BasicView<Reg, Imm, optional_t<Os...>, Cs...>::collect() const {
+        return collect_impl<true>();
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    std::vector<typename Reg::entity_type> BasicView<Reg, Imm, optional_t<Os...>, Cs...>::collect() requires (!Imm) {
+        return collect_impl<false>();
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    template<bool Const>
+    auto BasicView<Reg, Imm, optional_t<Os...>, Cs...>::collect_impl() const {
+        using entity_t = std::conditional_t<Const, const_entity_type, entity_type>;
+
+        std::vector<entity_t> collected;
+        collected.reserve(driver_->size() - driver_->tombstones()); // Upper bound, all the live driving entities
+        for (size_t pos = 0; pos < entities_->size(); ++pos)
+            if (contains(pos))
+                collected.emplace_back((*entities_)[pos], registry_);
+        return collected;
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    template<auto Member>
+    auto BasicView<Reg, Imm, optional_t<Os...>, Cs...>::column() const
+        requires (sizeof...(Cs) == 1 && (is_soa_v<std::remove_const_t<Cs> > && ...)) {
+        return std::get<0>(storages_)->template column<Member>();
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    bool BasicView<Reg, Imm, optional_t<Os...>, Cs...>::empty() const {
         return begin() == end();
     }
 
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    bool BasicView<Reg, Imm, optional_t<Os...>, Cs...>::contains(const size_t pos) const {
+        const id_t entity_id = (*entities_)[pos];
+        // Removed components of the driving storage show up as NO_ID
+        return entity_id != NO_ID
+               && (... && (std::get<storage_t<Cs>*>(storages_) == driver_
+                           || std::get<storage_t<Cs>*>(storages_)->entity_has(entity_id)))
+               && !(has_excluded_ && registry_->signatures_[to_index(entity_id)].intersects(excluded_))
+               && (tick_filters_.empty() || passes_tick_filters(pos, entity_id));
+    }
+
+    // Filters on the driving storage read its ticks directly, the others go through a lookup
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    bool BasicView<Reg, Imm, optional_t<Os...>, Cs...>::passes_tick_filters(const size_t pos,
+                                                                            const id_t entity_id) const {
+        return std::ranges::all_of(tick_filters_, [&](const detail::TickFilter& filter) {
+            if (filter.storage == driver_)
+                return (filter.added ? driver_->added_ticks() : driver_->changed_ticks())[pos] >= since_;
+            if (!filter.storage)
+                return false;
+            return filter.added
+                       ? filter.storage->added_since(entity_id, since_)
+                       : filter.storage->changed_since(entity_id, since_);
+        });
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    View<Imm, Cs...>::iterator_base<Const>::iterator_base(view_t* view, typename Storage<first_t<Cs...> >::iterator it):
-        view_(view), it_(it) {
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::iterator_base(view_t* view, const size_t pos):
+        view_(view), pos_(pos) {
         advance_till_valid();
     }
 
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    bool View<Imm, Cs...>::iterator_base<Const>::operator==(const iterator_base& other) const {
-        return view_ == other.view_ && it_ == other.it_;
+    bool BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator==(
+        const iterator_base& other) const {
+        return view_ == other.view_ && pos_ == other.pos_;
     }
 
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    typename View<Imm, Cs...>::template iterator_base<Const>::reference View<Imm, Cs...>::iterator_base<Const>
-    ::operator*() const {
-        return Entity(*it_, view_->registry_);
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::template iterator_base<Const>::reference
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator*() const {
+        return reference((*view_->entities_)[pos_], view_->registry_);
     }
 
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    typename View<Imm, Cs...>::template iterator_base<Const>& View<Imm, Cs...>::iterator_base<Const>::operator++() {
-        ++it_;
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::template iterator_base<Const>&
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator++() {
+        ++pos_;
         advance_till_valid();
         return *this;
     }
 
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    typename View<Imm, Cs...>::template iterator_base<Const> View<Imm, Cs...>::iterator_base<Const>::operator++(int) {
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::template iterator_base<Const>
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::operator++(int) {
         auto tmp = *this;
         ++(*this);
         return tmp;
     }
 
-    template<bool Imm, typename... Cs>
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
     template<bool Const>
-    void View<Imm, Cs...>::iterator_base<Const>::advance_till_valid() {
-        const auto it_end = std::get<0>(view_->storages_)->end();
-        while (it_ != it_end) {
-            if ((... && std::get<Storage<Cs>*>(view_->storages_)->entity_has(*it_)))
-                break;
-            ++it_;
-        }
+    void BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator_base<Const>::advance_till_valid() {
+        const std::vector<id_t>& entities = *view_->entities_;
+        while (pos_ < entities.size() && !view_->contains(pos_))
+            ++pos_;
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::const_iterator
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::begin() const {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::const_iterator
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::end() const {
+        return const_iterator(this, entities_->size());
     }
 
-    template<bool Imm, typename... Cs>
-    typename View<Imm, Cs...>::const_iterator View<Imm, Cs...>::begin() const {
-        return const_iterator(this, std::get<0>(storages_)->begin());
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::begin() requires (!Imm) {
+        return iterator(this, 0);
     }
 
-    template<bool Imm, typename... Cs>
-    typename View<Imm, Cs...>::const_iterator View<Imm, Cs...>::end() const {
-        return const_iterator(this, std::get<0>(storages_)->end());
+    template<typename Reg, bool Imm, typename... Os, typename... Cs>
+    typename BasicView<Reg, Imm, optional_t<Os...>, Cs...>::iterator
+    BasicView<Reg, Imm, optional_t<Os...>, Cs...>::end() requires (!Imm) {
+        return iterator(this, entities_->size());
     }
 
-    template<bool Imm, typename... Cs>
-    typename View<Imm, Cs...>::iterator View<Imm, Cs...>::begin() requires (!Imm) {
-        return iterator(this, std::get<0>(storages_)->begin());
+    template<typename Reg>
+    template<typename... Cs, typename... Fs>
+    auto BasicContext<Reg>::view(Fs... filters) const {
+        return std::as_const(*registry_).template view<Cs...>(filters...);
     }
 
-    template<bool Imm, typename... Cs>
-    typename View<Imm, Cs...>::iterator View<Imm, Cs...>::end() requires (!Imm) {
-        return iterator(this, std::get<0>(storages_)->end());
+    template<typename Reg>
+    template<typename... Cs, typename... Fs>
+    auto BasicContext<Reg>::view(Fs... filters) {
+        return registry_->template view<Cs...>(filters...);
     }
 
+    template<typename Reg>
     template<typename... Cs>
-    ImmutableView<Cs...> Context::view() const {
-        return registry_->view<Cs...>();
+    decltype(auto) BasicContext<Reg>::group() {
+        return registry_->template group<Cs...>();
     }
 
+    template<typename Reg>
     template<typename... Cs>
-    MutableView<Cs...> Context::view() {
-        return registry_->view<Cs...>();
+    void BasicContext<Reg>::par_for_each(auto&& callable, const size_t grain) {
+        auto view = registry_->template view<Cs...>();
+        if (pool_) {
+            view.par_for_each(*pool_, callable, grain, cycle_);
+        } else {
+            ThreadPool serial(0);
+            view.par_for_each(serial, callable, grain, cycle_);
+        }
     }
 
-    inline Context::Context(Registry* registry, const size_t cycle): cycle_(cycle), registry_(registry) {}
+    template<typename Reg>
+    BasicContext<Reg>::BasicContext(Reg* registry, const size_t cycle, ThreadPool* pool,
+                                    BasicCommandBuffer<Reg>* commands):
+        cycle_(cycle), registry_(registry), pool_(pool), commands_(commands) {}
 
-    inline size_t Context::cycle() const {
+    template<typename Reg>
+    size_t BasicContext<Reg>::cycle() const {
         return cycle_;
     }
 
-    inline ConstEntity Context::get_entity(id_t entity_id) const {
+    template<typename Reg>
+    template<typename C>
+    std::vector<id_t> BasicContext<Reg>::removed() const {
+        return registry_->template removed<C>();
+    }
+
+    template<typename Reg>
+    typename BasicContext<Reg>::const_entity_type BasicContext<Reg>::get_entity(id_t entity_id) const {
         return {entity_id, registry_};
     }
 
-    inline Entity Context::get_entity(id_t entity_id) {
+    template<typename Reg>
+    typename BasicContext<Reg>::entity_type BasicContext<Reg>::get_entity(id_t entity_id) {
         return {entity_id, registry_};
     }
 
-    inline void Context::remove_entity(const ConstEntity entity) { // NOLINT
+    template<typename Reg>
+    typename BasicContext<Reg>::entity_type BasicContext<Reg>::create_entity() {
+        return registry_->create();
+    }
+
+    template<typename Reg>
+    void BasicContext<Reg>::remove_entity(const const_entity_type entity) { // NOLINT
         registry_->remove(entity);
     }
 
-    inline void Context::remove_entity(const id_t entity_id) {
+    template<typename Reg>
+    void BasicContext<Reg>::remove_entity(const id_t entity_id) {
         remove_entity(get_entity(entity_id));
     }
+
+    template<typename Reg>
+    BasicCommandBuffer<Reg>& BasicContext<Reg>::commands() const {
+        if (!commands_)
+            throw std::logic_error("Context has no command buffer");
+        return *commands_;
+    }
+
+    template<typename Reg>
+    template<typename C, typename... Others>
+    void BasicContext<Reg>::sort_by(auto&& key) {
+        registry_->template sort_by<C, Others...>(std::forward<decltype(key)>(key));
+    }
 }
 #endif //VIEW_H
@@ -0,0 +1,144 @@
+#ifndef HEADLESS_RENDERER_H
+#define HEADLESS_RENDERER_H
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "sim/Dispatcher.h"
+#include "sim/Event.h"
+#include "sim/View.h"
+#include "sim/lib/components/Sprite.h"
+#include "sim/lib/components/Transform.h"
+#include "sim/lib/utils/Framebuffer.h"
+
+namespace sim::lib {
+    /// @brief The file format of the frames written by HeadlessRenderer.
+    enum class FrameFormat {
+        /// @brief One binary PPM image per frame, `frame_<cycle>.ppm`.
+        Ppm,
+        /// @brief All frames appended to a single `frames.rgba` file of raw RGBA frames, truncated by the first run
+        /// of the simulation only, e.g. for `ffmpeg -f rawvideo -pixel_format rgba -video_size 1020x1020 -i frames.rgba out.mp4`.
+        Raw
+    };
+
+    namespace detail {
+        /// @brief A string literal usable as a template argument.
+        /// @tparam N The size of the literal, including the terminating null.
+        template<size_t N>
+        struct FixedString {
+            char chars[N]{};
+
+            constexpr FixedString(const char (&string)[N]) { // NOLINT
+                std::copy_n(string, N, chars);
+            }
+        };
+    }
+
+    /// @brief A renderer that needs no window: it rasterizes the sprites into a Framebuffer and writes it to files.
+    /// @details Sprites are drawn as the windowed Renderer draws them, so the frames look the same,
+    /// which allows producing visual output of simulations running on machines without any display.
+    /// Doesn't depend on raylib, so it's also available when the framework is built without it.
+    /// @tparam Period The number of cycles between two written frames.
+    /// @tparam Format The file format of the frames.
+    /// @tparam Directory The directory the frames are written to, created if needed.
+    template<size_t Period = 1, FrameFormat Format = FrameFormat::Ppm, detail::FixedString Directory = "frames">
+    class HeadlessRenderer {
+        static constexpr int MARGIN = 10; // Margin around the frame
+        static constexpr Color BACKGROUND{245, 245, 245, 255};
+
+        Framebuffer framebuffer_{1000 + 2 * MARGIN, 1000 + 2 * MARGIN};
+        std::ofstream stream_; // The raw video stream, if the format is Raw, kept open across runs
+
+    public:
+        /// @brief Only reads the sprites, so other systems may run while it draws, see Dispatcher.
+        using reads = components<Transform, Sprite>;
+
+        template<typename Event>
+        void operator()(const Event& event, ContextC auto context);
+
+        /// @brief Get the framebuffer holding the last drawn frame.
+        /// @return A const reference to the framebuffer.
+        [[nodiscard]] const Framebuffer& framebuffer() const;
+
+    private:
+        void start();
+
+        void end();
+
+        void draw(ContextC auto context);
+
+        void write(size_t cycle);
+
+        static std::ofstream open(const std::filesystem::path& path);
+    };
+
+    // Implementation ============================================================================
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    template<typename Event>
+    void HeadlessRenderer<Period, Format, Directory>::operator()(const Event&, ContextC auto context) {
+        if constexpr (std::same_as<Event, event::SimStart>) {
+            start();
+        } else if constexpr (std::same_as<Event, event::SimEnd>) {
+            end();
+        } else if constexpr (std::same_as<Event, event::Render>) {
+            if (context.cycle() % Period != 0) return;
+            draw(context);
+            write(context.cycle());
+        }
+    }
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    const Framebuffer& HeadlessRenderer<Period, Format, Directory>::framebuffer() const {
+        return framebuffer_;
+    }
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    void HeadlessRenderer<Period, Format, Directory>::start() {
+        std::filesystem::create_directories(Directory.chars);
+        if constexpr (Format == FrameFormat::Raw) {
+            if (!stream_.is_open()) // Later runs append to the frames of the previous ones
+                stream_ = open(std::filesystem::path(Directory.chars) / "frames.rgba");
+        }
+    }
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    void HeadlessRenderer<Period, Format, Directory>::end() {
+        if constexpr (Format == FrameFormat::Raw)
+            stream_.flush();
+    }
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    void HeadlessRenderer<Period, Format, Directory>::draw(ContextC auto context) {
+        framebuffer_.clear(BACKGROUND);
+        std::as_const(context).template view<Transform, Sprite>().for_each([this](const Transform& t, const Sprite& sprite) {
+            framebuffer_.fill_rect(t.x - sprite.width / 2 + MARGIN, t.y - sprite.height / 2 + MARGIN,
+                                   sprite.width, sprite.height, sprite.color);
+        });
+    }
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    void HeadlessRenderer<Period, Format, Directory>::write(const size_t cycle) {
+        if constexpr (Format == FrameFormat::Raw) {
+            framebuffer_.write_raw(stream_);
+        } else {
+            std::ostringstream name;
+            name << "frame_" << std::setw(6) << std::setfill('0') << cycle << ".ppm";
+            std::ofstream file = open(std::filesystem::path(Directory.chars) / name.str());
+            framebuffer_.write_ppm(file);
+        }
+    }
+
+    template<size_t Period, FrameFormat Format, detail::FixedString Directory>
+    std::ofstream HeadlessRenderer<Period, Format, Directory>::open(const std::filesystem::path& path) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Cannot open frame file " + path.string());
+        return file;
+    }
+}
+
+#endif //HEADLESS_RENDERER_H
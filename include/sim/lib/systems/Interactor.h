@@ -1,5 +1,8 @@
 #ifndef INTERACTOR_H
 #define INTERACTOR_H
+#include <unordered_set>
+
+#include "sim/Dispatcher.h"
 #include "sim/Event.h"
 #include "sim/View.h"
 #include "sim/lib/components/Interactions.h"
@@ -9,20 +12,28 @@
 namespace sim::lib {
     template<typename... Touchables>
     struct TouchableTargets {
-        void operator()(const event::Cycle, const Context ctx) const {
-            (process<Touchables>(ctx), ...);
+        // Touched entities are removed through the command buffer, so this never changes the registry directly
+        using reads = components<Transform, DestroyByTouch<Touchables>..., Touchables...>;
+
+        // The destroyed entities are only removed once the cycle ends, so they are tracked meanwhile:
+        // the first toucher consumes a target, and a consumed entity touches nothing afterward
+        void operator()(const event::Cycle, ContextC auto ctx) const {
+            std::unordered_set<id_t> consumed;
+            (process<Touchables>(ctx, consumed), ...);
         }
 
     private:
         template<typename Touchable>
-        void process(Context ctx) const {
-            ctx.view<Transform, DestroyByTouch<Touchable> >()
-                    .for_each([&](const Entity& toucher, auto& t, auto& td) {
+        void process(ContextC auto ctx, std::unordered_set<id_t>& consumed) const {
+            std::as_const(ctx).template view<Transform, DestroyByTouch<Touchable> >()
+                    .for_each([&](const auto& toucher, const auto& t, const auto& td) {
+                            if (consumed.contains(toucher.id())) return;
                             const dim_t min_dist_squared = td.min_distance * td.min_distance;
-                            ctx.view<Touchable>().for_each([&](Entity& touched, auto&) {
-                                if (toucher.id() != touched.id()
-                                    && dist_squared(t, touched.get<Transform>()) < min_dist_squared) {
-                                    ctx.remove_entity(touched);
+                            std::as_const(ctx).template view<Touchable>().for_each([&](auto touched, const auto&) {
+                                if (toucher.id() != touched.id() && !consumed.contains(touched.id())
+                                    && dist_squared(t, touched.template get<Transform>()) < min_dist_squared) {
+                                    consumed.insert(touched.id());
+                                    ctx.commands().destroy(touched);
                                 }
                             });
                         }
@@ -1,8 +1,11 @@
 #ifndef MOVEMENT_H
 #define MOVEMENT_H
+#include <algorithm>
 #include <random>
 #include <ranges>
+#include <span>
 
+#include "sim/Dispatcher.h"
 #include "sim/Event.h"
 #include "sim/View.h"
 #include "sim/lib/components/Transform.h"
@@ -10,32 +13,67 @@
 
 namespace sim::lib {
     /// @brief System add simple movement mechanics. Entities to move must have `Movable` and `Target` components.
+    /// @details Iterates a view, so it leaves the order of the storages to others, e.g. SpatialSort or a group.
+    /// See GroupedMovement for a faster variant owning the storages.
     struct Movement {
+        /// @brief The components the system reads, see Dispatcher.
+        using reads = components<Movable>;
+
+        /// @brief The components the system writes, see Dispatcher.
+        using writes = components<Transform, Target>;
+
         /// @brief Event handler for moving entities towards their targets.
-        void operator()(const event::Cycle, Context ctx) const {
-            ctx.view<Transform, Movable, Target>()
-                    .for_each([&](Transform& t, const Movable& m, Target& to) {
-                        const auto dx = to.x - t.x;
-                        const auto dy = to.y - t.y;
-
-                        // Move towards the target but clamp to not overshoot the target
-                        if (dx != 0) {
-                            t.x += m.speed * (dx > 0 ? 1 : -1);
-                            if ((dx > 0 && t.x > to.x) || (dx < 0 && t.x < to.x))
-                                t.x = to.x; // Clamp to target
-                        }
+        void operator()(const event::Cycle, ContextC auto ctx) const {
+            ctx.template view<Transform, const Movable, Target>().for_each(move);
+        }
 
-                        if (dy != 0) {
-                            t.y += m.speed * (dy > 0 ? 1 : -1);
-                            if ((dy > 0 && t.y > to.y) || (dy < 0 && t.y < to.y))
-                                t.y = to.y; // Clamp to target
-                        }
+    protected:
+        // Moves towards the target by at most the speed per axis, so it never overshoots.
+        // Branch-free, so loops over chunks can be vectorized.
+        static void move(Transform& t, const Movable& m, Target& to) {
+            t.x += std::max(-m.speed, std::min(m.speed, to.x - t.x));
+            t.y += std::max(-m.speed, std::min(m.speed, to.y - t.y));
 
-                        // Reset target to self
-                        to.x = t.x;
-                        to.y = t.y;
-                    });
+            // Reset target to self
+            to.x = t.x;
+            to.y = t.y;
+        }
+    };
+
+    /// @brief Movement iterating an owning group of `Transform`, `Movable` and `Target` chunk by chunk.
+    /// @details The group is created on SimStart and owns these storages for the whole simulation,
+    /// so none of them can be owned by another group, e.g. through `group<Transform, Movable, Target>()`,
+    /// which throws. Sorting them, e.g. with SpatialSort, packs the group again.
+    /// Behaves like Movement if any of them isn't stored in a DensePool.
+    struct GroupedMovement : Movement {
+        /// @brief The components the system reads, see Dispatcher.
+        using reads = components<>;
+
+        /// @brief The components the system writes, see Dispatcher. Movable is only read,
+        /// but creating the group reorders its storage.
+        using writes = components<Transform, Movable, Target>;
+
+        /// @brief Event handler creating the group.
+        void operator()(const event::SimStart, ContextC auto ctx) const {
+            if constexpr (GROUPED)
+                (void) ctx.template group<Transform, const Movable, Target>();
+        }
+
+        /// @brief Event handler for moving entities towards their targets.
+        void operator()(const event::Cycle, ContextC auto ctx) const {
+            if constexpr (GROUPED) {
+                ctx.template group<Transform, const Movable, Target>()
+                        .each_chunk([](std::span<Transform> ts, std::span<const Movable> ms, std::span<Target> tos) {
+                            for (size_t i = 0; i < ts.size(); ++i)
+                                move(ts[i], ms[i], tos[i]);
+                        });
+            } else {
+                Movement::operator()(event::Cycle{}, ctx);
+            }
         }
+
+    private:
+        static constexpr bool GROUPED = is_dense_v<Transform> && is_dense_v<Movable> && is_dense_v<Target>;
     };
 
     /// @brief System to resolve targets for entities. It can handle static and dynamic targets.
@@ -52,8 +90,15 @@ namespace sim::lib {
         std::uniform_int_distribution<dim_t> dist_{-1, 1};
 
     public:
+        /// @brief The components the system reads, see Dispatcher.
+        using reads = components<Transform, RandomTarget, StaticEntityTarget, StaticEntityAvoid,
+            FollowClosest<DynamicTs>..., AvoidClosest<DynamicTs>..., DynamicTs...>;
+
+        /// @brief The components the system writes, see Dispatcher.
+        using writes = components<Target>;
+
         /// @brief Event handler for resolving targets for entities.
-        void operator()(const event::PreCycle, const Context ctx) {
+        void operator()(const event::PreCycle, ContextC auto ctx) {
             resolve_random(ctx);
             resolve_avoid_entity(ctx);
             resolve_target_entity(ctx);
@@ -64,90 +109,91 @@ namespace sim::lib {
         }
 
     private:
-        void resolve_random(Context ctx) {
-            ctx.view<Transform, Target, RandomTarget>()
-                    .for_each([this](const Transform& t, Target& to, RandomTarget&) {
+        void resolve_random(ContextC auto ctx) {
+            ctx.template view<const Transform, Target, const RandomTarget>()
+                    .for_each([this](const Transform& t, Target& to, const RandomTarget&) {
                         to.x = t.x + dist_(rng_) * RANDOM_MOVE_RANGE;
                         to.y = t.y + dist_(rng_) * RANDOM_MOVE_RANGE;
                     });
         }
 
-        static void resolve_target_entity(Context ctx) {
-            ctx.view<Transform, Target, StaticEntityTarget>()
+        static void resolve_target_entity(ContextC auto ctx) {
+            ctx.template view<const Transform, Target, const StaticEntityTarget>()
                     .for_each([&](const Transform&, Target& to, const StaticEntityTarget& target) {
-                        const auto target_entity = ctx.get_entity(target.target_entity);
-                        if (!target_entity.has<Transform>()) return;
+                        const auto target_entity = std::as_const(ctx).get_entity(target.target_entity);
+                        if (!target_entity.template has<Transform>()) return;
 
-                        const auto [x, y] = target_entity.get<Transform>();
+                        const auto [x, y] = target_entity.template get<Transform>();
                         to.x = x;
                         to.y = y;
                     });
         }
 
-        static void resolve_avoid_entity(Context ctx) {
-            ctx.view<Transform, Target, StaticEntityAvoid>()
+        static void resolve_avoid_entity(ContextC auto ctx) {
+            ctx.template view<const Transform, Target, const StaticEntityAvoid>()
                     .for_each([&](const Transform& t, Target& to, const StaticEntityAvoid& target) {
-                        const auto target_entity = ctx.get_entity(target.target_entity);
-                        if (!target_entity.has<Transform>()) return;
+                        const auto target_entity = std::as_const(ctx).get_entity(target.target_entity);
+                        if (!target_entity.template has<Transform>()) return;
 
-                        const auto [x, y] = target_entity.get<Transform>();
+                        const auto [x, y] = target_entity.template get<Transform>();
                         // Move away from the target
                         to.x = (x < t.x) ? 1 : -1; // Move away in x direction
                         to.y = (y < t.y) ? 1 : -1; // Move away in y direction
                     });
         }
 
+        // The closest entity searches are quadratic, so they run in parallel,
+        // sharing one collected list of the potential targets that is only read
         template<typename T>
-        static void resolve_follow_dynamic(Context ctx) {
-            ctx.view<Transform, Target, FollowClosest<T> >()
-                    .for_each([&](const Entity& self, Transform& t, Target& to, FollowClosest<T>&) {
+        static void resolve_follow_dynamic(ContextC auto ctx) {
+            const auto potential_targets = std::as_const(ctx).template view<Transform, T>().collect();
+            if (potential_targets.empty())
+                return; // No targets to follow, keep the current target
+
+            ctx.template par_for_each<const Transform, Target, const FollowClosest<T> >(
+                    [&](const auto& self, const Transform& t, Target& to, const FollowClosest<T>&) {
                         // Dist metric
-                        auto dist = [&](const Entity& to_entity) {
+                        auto dist = [&](const auto& to_entity) {
                             if (self.id() == to_entity.id())
                                 return std::numeric_limits<dim_t>::max(); // Ignore self
 
                             const auto& [s_x, s_y] = t;
-                            const auto& [to_x, to_y] = to_entity.get<Transform>();
+                            const auto& [to_x, to_y] = to_entity.template get<Transform>();
                             return (s_x - to_x) * (s_x - to_x) + (s_y - to_y) * (s_y - to_y);
                         };
 
-                        auto potential_targets = ctx.view<Transform, T>();
-                        if (potential_targets.empty()) {
-                            return;
-                            to.x = t.x; // No targets to follow, stay in place
-                            to.y = t.y;
-                        }
-
-                        const Entity closest = std::ranges::min(potential_targets, {}, dist);
-                        const auto [x, y] = closest.get<Transform>();
+                        const auto closest = std::ranges::min(potential_targets, {}, dist);
+                        const auto [x, y] = closest.template get<Transform>();
                         to.x = x;
                         to.y = y;
                     });
         }
 
         template<typename T>
-        static void resolve_avoid_dynamic(Context ctx) {
-            ctx.view<Transform, Target, AvoidClosest<T> >()
-                    .for_each([&](const Entity& self, Transform& t, Target& to, AvoidClosest<T>&) {
+        static void resolve_avoid_dynamic(ContextC auto ctx) {
+            const auto potential_targets = std::as_const(ctx).template view<Transform, T>().collect();
+            const bool no_targets = potential_targets.empty();
+
+            ctx.template par_for_each<const Transform, Target, const AvoidClosest<T> >(
+                    [&](const auto& self, const Transform& t, Target& to, const AvoidClosest<T>&) {
                         // Dist metric
-                        auto dist = [&](const Entity& to_entity) {
+                        auto dist = [&](const auto& to_entity) {
                             if (self.id() == to_entity.id())
                                 return std::numeric_limits<dim_t>::max(); // Ignore self
 
                             const auto& [s_x, s_y] = t;
-                            const auto& [to_x, to_y] = to_entity.get<Transform>();
+                            const auto& [to_x, to_y] = to_entity.template get<Transform>();
                             return (s_x - to_x) * (s_x - to_x) + (s_y - to_y) * (s_y - to_y);
                         };
 
-                        auto potential_targets = ctx.view<Transform, T>();
-                        if (potential_targets.empty()) {
-                            to.x = t.x; // No targets to follow, stay in place
+                        if (no_targets) {
+                            to.x = t.x; // No targets to avoid, stay in place
                             to.y = t.y;
                             return;
                         }
 
-                        const Entity closest = std::ranges::min(potential_targets, {}, dist);
-                        const auto [x, y] = closest.get<Transform>();
+                        const auto closest = std::ranges::min(potential_targets, {}, dist);
+                        const auto [x, y] = closest.template get<Transform>();
                         // Move away from the target
                         to.x = x < t.x ? t.x + 1 : t.x - 1; // Move away in x direction
                         to.y = y < t.y ? t.y + 1 : t.y - 1; // Move away in y direction
@@ -1,39 +1,110 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 #include <memory>
-#include "sim/Simulation.h"
+#include <span>
+#include <vector>
+
+#include "sim/Dispatcher.h"
+#include "sim/Event.h"
+#include "sim/TripleBuffer.h"
+#include "sim/View.h"
+#include "sim/lib/components/Sprite.h"
+#include "sim/lib/components/Transform.h"
 
 namespace sim::lib {
     /// @brief A simple renderer that renders the simulation state.
     /// @details Uses PIMP to forward the calls to an implementation.
     class Renderer {
+    public:
+        /// @brief A sprite to draw at a position.
+        struct Drawable {
+            Transform transform;
+            Sprite sprite;
+        };
+
+    private:
         struct State;
         std::unique_ptr<State> state_;
+        std::vector<Drawable> drawables_; // Gathered every frame, reused to avoid reallocations
 
     public:
         Renderer();
         ~Renderer();
 
         template<typename Event>
-        void operator()(const Event& event, Context context);
+        void operator()(const Event& event, ContextC auto context);
 
         void start();
 
         void end() const;
 
-        void render(Context context) const;
+        void render(std::span<const Drawable> drawables) const;
 
         void wait() const;
     };
 
+    /// @brief A renderer drawing on its own thread, so the simulation isn't held back by the frame rate.
+    /// @details On every Render event, the simulation thread only copies the sprites into a snapshot
+    /// and publishes it through a TripleBuffer. The render thread owns the window and draws the latest snapshot
+    /// at the refresh rate, skipping the snapshots published in between, so the simulation runs as fast as it can.
+    /// At the end of the simulation, the last snapshot stays on screen until the window is closed.
+    /// GLFW only creates windows off the main thread on Linux and Windows. On macOS, Cocoa requires the main thread,
+    /// so there the window is opened on the simulation thread, which must be the main one,
+    /// and every snapshot is drawn as it's published, as Renderer does.
+    class ThreadedRenderer {
+        struct State;
+        TripleBuffer<std::vector<Renderer::Drawable> > snapshots_; // Outlives the render thread, joined by state_
+        std::unique_ptr<State> state_;
+
+    public:
+        /// @brief Only reads the sprites, so other systems may run during the snapshot, see Dispatcher.
+        using reads = components<Transform, Sprite>;
+
+        ThreadedRenderer();
+        ~ThreadedRenderer();
+
+        template<typename Event>
+        void operator()(const Event& event, ContextC auto context);
+
+        /// @brief Starts the render thread, which opens the window, or opens it on this thread on macOS.
+        void start();
+
+        /// @brief Draws the latest snapshot on macOS, where there is no render thread. Does nothing elsewhere.
+        void present();
+
+        /// @brief Waits until the window is closed, then joins the render thread.
+        void end();
+    };
+
+    template<typename Event>
+    void Renderer::operator()(const Event&, ContextC auto context) {
+        if constexpr (std::same_as<Event, event::SimStart>) {
+            start();
+        } else if constexpr (std::same_as<Event, event::SimEnd>) {
+            end();
+        } else if constexpr (std::same_as<Event, event::Render>) {
+            drawables_.clear();
+            std::as_const(context).template view<Transform, Sprite>().for_each([this](const Transform& t, const Sprite& sprite) {
+                drawables_.push_back({t, sprite});
+            });
+            render(drawables_);
+        }
+    }
+
     template<typename Event>
-    void Renderer::operator()(const Event&, const Context context) {
+    void ThreadedRenderer::operator()(const Event&, ContextC auto context) {
         if constexpr (std::same_as<Event, event::SimStart>) {
             start();
         } else if constexpr (std::same_as<Event, event::SimEnd>) {
             end();
         } else if constexpr (std::same_as<Event, event::Render>) {
-            render(context);
+            std::vector<Renderer::Drawable>& snapshot = snapshots_.back();
+            snapshot.clear();
+            std::as_const(context).template view<Transform, Sprite>().for_each([&](const Transform& t, const Sprite& sprite) {
+                snapshot.push_back({t, sprite});
+            });
+            snapshots_.publish();
+            present();
         }
     }
 }
@@ -0,0 +1,23 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+#include "sim/Event.h"
+#include "sim/View.h"
+#include "sim/lib/components/Transform.h"
+#include "sim/lib/utils/TransformUtils.h"
+
+namespace sim::lib {
+    /// @brief System that periodically sorts entities by the Morton key of their Transform.
+    /// @details Entities close in space then end up close in memory,
+    /// so neighbor-heavy systems like TargetResolver and TouchableTargets stream through nearby components.
+    /// @tparam Period The number of cycles between two sorts.
+    /// @tparam Cs Other component types to arrange in the same order as Transform.
+    template<size_t Period, typename... Cs>
+    struct SpatialSort {
+        void operator()(const event::PostCycle, ContextC auto ctx) const {
+            if (ctx.cycle() % Period != 0) return;
+            ctx.template sort_by<Transform, Cs...>(morton_key);
+        }
+    };
+}
+
+#endif //SPATIAL_H
@@ -1,24 +1,55 @@
 #ifndef WORLD_H
 #define WORLD_H
+#include <algorithm>
+#include <span>
+
+#include "sim/Dispatcher.h"
 #include "sim/Event.h"
 #include "sim/View.h"
 #include "sim/lib/components/Transform.h"
 
 namespace sim::lib {
     /// @brief A system that enforces world boundaries for entities with Transform components.
+    /// @details If Transform opts in to change tracking (see track_changes) and the registry keeps change ticks
+    /// (see has_change_ticks_v), only the positions changed since the previous cycle are visited, through a const view,
+    /// and only those outside the world are written, so the system doesn't mark the positions it merely checks as changed.
     struct WorldBoundary {
         static constexpr dim_t MIN_X = 0; // Minimum X coordinate
         static constexpr dim_t MIN_Y = 0; // Minimum Y coordinate
         static constexpr dim_t MAX_X = 1000; // Maximum X coordinate
         static constexpr dim_t MAX_Y = 1000; // Maximum Y coordinate
 
-        void operator()(const event::PostCycle, Context ctx) const {
-            ctx.view<Transform>().for_each([](auto& t) {
-                if (t.x < MIN_X) t.x = MIN_X;
-                if (t.y < MIN_Y) t.y = MIN_Y;
-                if (t.x > MAX_X) t.x = MAX_X;
-                if (t.y > MAX_Y) t.y = MAX_Y;
-            });
+        /// @brief The components the system writes, see Dispatcher.
+        using writes = components<Transform>;
+
+        void operator()(const event::PostCycle, ContextC auto ctx) const {
+            if constexpr (is_tracked_v<Transform> && has_change_ticks_v<typename decltype(ctx)::registry_type>) {
+                std::as_const(ctx).template view<Transform>(changed<Transform>)
+                        .for_each([&](const auto& entity, const auto& t) {
+                            Transform confined = t;
+                            confine(confined);
+                            if (confined.x != t.x || confined.y != t.y)
+                                ctx.get_entity(entity.id()).template get<Transform>() = confined;
+                        });
+                return;
+            }
+
+            auto transforms = ctx.template view<Transform>();
+            if constexpr (is_dense_v<Transform>) {
+                transforms.each_chunk([](std::span<Transform> ts) {
+                    for (Transform& t: ts)
+                        confine(t);
+                });
+            } else {
+                transforms.for_each([](auto& t) { confine(t); });
+            }
+        }
+
+    private:
+        // Clamps a position into the world, branch-free so loops over chunks can be vectorized
+        static void confine(auto& t) {
+            t.x = std::clamp(t.x, MIN_X, MAX_X);
+            t.y = std::clamp(t.y, MIN_Y, MAX_Y);
         }
     };
 }
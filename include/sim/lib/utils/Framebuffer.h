@@ -0,0 +1,59 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "sim/lib/components/Sprite.h"
+
+namespace sim::lib {
+    /// @brief An in-memory RGBA image that sprites are rasterized into, without any window or graphics library.
+    /// @details Pixels are stored row by row, each as the bytes R, G, B, A in memory.
+    /// Rectangles are drawn as runs of whole rows, plain fills the compiler vectorizes.
+    class Framebuffer {
+        size_t width_;
+        size_t height_;
+        std::vector<uint32_t> pixels_;
+
+    public:
+        /// @brief Constructs a black framebuffer.
+        /// @param width The width in pixels.
+        /// @param height The height in pixels.
+        Framebuffer(size_t width, size_t height);
+
+        /// @brief Get the width of the framebuffer.
+        /// @return The width in pixels.
+        [[nodiscard]] size_t width() const;
+
+        /// @brief Get the height of the framebuffer.
+        /// @return The height in pixels.
+        [[nodiscard]] size_t height() const;
+
+        /// @brief Get the pixels, row by row.
+        /// @return The pixels, each holding the bytes R, G, B, A in memory.
+        [[nodiscard]] std::span<const uint32_t> pixels() const;
+
+        /// @brief Fills the whole framebuffer with a color.
+        /// @param color The color.
+        void clear(const Color& color);
+
+        /// @brief Draws a rectangle, clipped to the framebuffer. Translucent colors are blended with the pixels below.
+        /// @param x The left edge.
+        /// @param y The top edge.
+        /// @param width The width of the rectangle.
+        /// @param height The height of the rectangle.
+        /// @param color The color.
+        void fill_rect(int x, int y, int width, int height, const Color& color);
+
+        /// @brief Writes the framebuffer as a binary PPM (P6) image, dropping the alpha channel.
+        /// @param out The stream to write to, opened in binary mode.
+        void write_ppm(std::ostream& out) const;
+
+        /// @brief Writes the raw RGBA bytes of the framebuffer, e.g. as one frame of a raw video stream.
+        /// @param out The stream to write to, opened in binary mode.
+        void write_raw(std::ostream& out) const;
+    };
+}
+
+#endif //FRAMEBUFFER_H
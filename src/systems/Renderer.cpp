@@ -1,4 +1,9 @@
+#include <atomic>
+#include <optional>
+#include <thread>
+
 #include "raylib-cpp.hpp"
+#include "rlgl.h"
 
 #include "sim/lib/systems/Renderer.h"
 #include "sim/lib/components/Transform.h"
@@ -6,32 +11,84 @@
 
 static constexpr int MARGIN = 10; // Margin around the screen
 
-namespace sim::lib {
-    struct Renderer::State {
-        static constexpr char TITLE[] = "Simulation Renderer";
-        static constexpr int WIDTH = 1000 + 2 * MARGIN;
-        static constexpr int HEIGHT = 1000 + 2 * MARGIN;
-        raylib::Window window;
-
-        State() : window(WIDTH, HEIGHT, TITLE) {
-            window.SetTargetFPS(60);
-        }
-    };
+// Cocoa only lets the main thread create windows and handle their events
+#ifdef __APPLE__
+static constexpr bool RENDER_THREAD = false;
+#else
+static constexpr bool RENDER_THREAD = true;
+#endif
 
+namespace sim::lib {
     namespace detail {
         struct Helper {
-            static raylib::Color toRaylibColor(const Color& color) {
-                return {color.r, color.g, color.b, color.a};
+            static constexpr char TITLE[] = "Simulation Renderer";
+            static constexpr int WIDTH = 1000 + 2 * MARGIN;
+            static constexpr int HEIGHT = 1000 + 2 * MARGIN;
+            static constexpr int FPS = 60;
+
+            static constexpr size_t RUN = 1024; // Quads submitted between two checks of the room left in the batch
+
+            // Submits the sprites as quads straight into the rlgl batch, skipping those outside the window.
+            // DrawRectangle would switch the texture and begin and end a draw for every sprite.
+            static void draw_sprites(const std::span<const Renderer::Drawable> drawables) {
+                rlSetTexture(rlGetTextureIdDefault());
+                for (size_t first = 0; first < drawables.size(); first += RUN) {
+                    rlCheckRenderBatchLimit(static_cast<int>(4 * RUN)); // Flushes the batch if the run may not fit
+                    rlBegin(RL_QUADS);
+                    for (const auto& [t, sprite]: drawables.subspan(first, std::min(RUN, drawables.size() - first))) {
+                        const int x = t.x - sprite.width / 2 + MARGIN;
+                        const int y = t.y - sprite.height / 2 + MARGIN;
+                        if (x >= WIDTH || y >= HEIGHT || x + sprite.width <= 0 || y + sprite.height <= 0)
+                            continue;
+
+                        const auto left = static_cast<float>(x);
+                        const auto top = static_cast<float>(y);
+                        const auto right = static_cast<float>(x + sprite.width);
+                        const auto bottom = static_cast<float>(y + sprite.height);
+                        rlColor4ub(sprite.color.r, sprite.color.g, sprite.color.b, sprite.color.a);
+                        rlVertex2f(left, top);
+                        rlVertex2f(left, bottom);
+                        rlVertex2f(right, bottom);
+                        rlVertex2f(right, top);
+                    }
+                    rlEnd();
+                }
+                rlSetTexture(0);
             }
 
-            static void draw_sprite(const Transform& t, const Sprite& sprite) {
-                const int x = t.x - sprite.width / 2 + MARGIN;
-                const int y = t.y - sprite.height / 2 + MARGIN;
-                DrawRectangle(x, y, sprite.width, sprite.height, toRaylibColor(sprite.color));
+            static void draw_frame(raylib::Window& window, const std::span<const Renderer::Drawable> drawables) {
+                window.BeginDrawing();
+
+                window.ClearBackground(raylib::RAYWHITE);
+
+                draw_sprites(drawables);
+
+                window.EndDrawing();
             }
         };
     }
 
+    struct Renderer::State {
+        raylib::Window window;
+
+        State() : window(detail::Helper::WIDTH, detail::Helper::HEIGHT, detail::Helper::TITLE) {
+            window.SetTargetFPS(detail::Helper::FPS);
+        }
+    };
+
+    // The window lives on the render thread, as the graphics context belongs to the thread that created it
+    struct ThreadedRenderer::State {
+        std::atomic<bool> stop = false; // Set to close the window before it's closed by the user
+        std::thread thread;
+        std::optional<raylib::Window> window; // Opened on the simulation thread instead, without a render thread
+
+        ~State() {
+            stop = true;
+            if (thread.joinable())
+                thread.join();
+        }
+    };
+
     Renderer::Renderer() = default;
     Renderer::~Renderer() = default;
 
@@ -43,17 +100,8 @@ namespace sim::lib {
         wait();
     }
 
-    void Renderer::render(Context context) const {
-        state_->window.BeginDrawing();
-
-        state_->window.ClearBackground(raylib::RAYWHITE);
-
-        context.view<Transform, Sprite>().for_each(
-            [](const Transform& t, const Sprite& sprite) {
-                detail::Helper::draw_sprite(t, sprite);
-            });
-
-        state_->window.EndDrawing();
+    void Renderer::render(const std::span<const Drawable> drawables) const {
+        detail::Helper::draw_frame(state_->window, drawables);
     }
 
     void Renderer::wait() const {
@@ -63,4 +111,42 @@ namespace sim::lib {
             WaitTime(0.01);
         }
     }
+
+    ThreadedRenderer::ThreadedRenderer() = default;
+    ThreadedRenderer::~ThreadedRenderer() = default;
+
+    void ThreadedRenderer::start() {
+        state_ = std::make_unique<State>();
+        if (!RENDER_THREAD) {
+            state_->window.emplace(detail::Helper::WIDTH, detail::Helper::HEIGHT, detail::Helper::TITLE);
+            state_->window->SetTargetFPS(detail::Helper::FPS);
+            return;
+        }
+        state_->thread = std::thread([this, &stop = state_->stop] {
+            raylib::Window window(detail::Helper::WIDTH, detail::Helper::HEIGHT, detail::Helper::TITLE);
+            window.SetTargetFPS(detail::Helper::FPS); // Paces this thread only
+            while (!stop && !window.ShouldClose()) {
+                snapshots_.refresh();
+                detail::Helper::draw_frame(window, snapshots_.front());
+            }
+        });
+    }
+
+    void ThreadedRenderer::present() {
+        if (!state_->window) return; // Drawn by the render thread
+        snapshots_.refresh();
+        detail::Helper::draw_frame(*state_->window, snapshots_.front());
+    }
+
+    void ThreadedRenderer::end() {
+        if (state_->window) {
+            while (!state_->window->ShouldClose()) {
+                PollInputEvents();
+                WaitTime(0.01);
+            }
+            return;
+        }
+        if (state_->thread.joinable())
+            state_->thread.join();
+    }
 }
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "sim/lib/utils/Framebuffer.h"
+
+namespace sim::lib {
+    namespace {
+        uint32_t pack(const Color& color) {
+            return std::bit_cast<uint32_t>(std::array<uint8_t, 4>{color.r, color.g, color.b, color.a});
+        }
+
+        uint8_t blend(const uint8_t below, const uint8_t above, const uint8_t alpha) {
+            return static_cast<uint8_t>((above * alpha + below * (255 - alpha) + 127) / 255);
+        }
+    }
+
+    Framebuffer::Framebuffer(const size_t width, const size_t height):
+        width_(width), height_(height), pixels_(width * height, pack(Color{})) {}
+
+    size_t Framebuffer::width() const {
+        return width_;
+    }
+
+    size_t Framebuffer::height() const {
+        return height_;
+    }
+
+    std::span<const uint32_t> Framebuffer::pixels() const {
+        return pixels_;
+    }
+
+    void Framebuffer::clear(const Color& color) {
+        std::ranges::fill(pixels_, pack(color));
+    }
+
+    void Framebuffer::fill_rect(const int x, const int y, const int width, const int height, const Color& color) {
+        const auto clip = [](const int from, const int size, const size_t limit) {
+            return std::pair<size_t, size_t>{
+                std::clamp<int64_t>(from, 0, static_cast<int64_t>(limit)),
+                std::clamp<int64_t>(static_cast<int64_t>(from) + size, 0, static_cast<int64_t>(limit))
+            };
+        };
+        const auto [left, right] = clip(x, width, width_);
+        const auto [top, bottom] = clip(y, height, height_);
+        if (left >= right || top >= bottom || color.a == 0) return;
+
+        const size_t span = right - left;
+        if (color.a == 255) {
+            const uint32_t pixel = pack(color);
+            for (size_t row = top; row < bottom; ++row)
+                std::fill_n(pixels_.data() + row * width_ + left, span, pixel);
+            return;
+        }
+
+        for (size_t row = top; row < bottom; ++row) {
+            auto* bytes = reinterpret_cast<uint8_t*>(pixels_.data() + row * width_ + left);
+            for (size_t i = 0; i < span * 4; i += 4) { // The alpha of the pixels below is kept
+                bytes[i] = blend(bytes[i], color.r, color.a);
+                bytes[i + 1] = blend(bytes[i + 1], color.g, color.a);
+                bytes[i + 2] = blend(bytes[i + 2], color.b, color.a);
+            }
+        }
+    }
+
+    void Framebuffer::write_ppm(std::ostream& out) const {
+        out << "P6\n" << width_ << ' ' << height_ << "\n255\n";
+        std::vector<char> row(width_ * 3);
+        for (size_t y = 0; y < height_; ++y) {
+            const auto* bytes = reinterpret_cast<const char*>(pixels_.data() + y * width_);
+            for (size_t x = 0; x < width_; ++x)
+                std::copy_n(bytes + x * 4, 3, row.data() + x * 3);
+            out.write(row.data(), static_cast<std::streamsize>(row.size()));
+        }
+    }
+
+    void Framebuffer::write_raw(std::ostream& out) const {
+        out.write(reinterpret_cast<const char*>(pixels_.data()),
+                  static_cast<std::streamsize>(pixels_.size() * sizeof(uint32_t)));
+    }
+}
@@ -0,0 +1,84 @@
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "sim/Simulation.h"
+
+struct Value {
+    int v;
+};
+
+struct Mark {
+    int v;
+};
+
+struct Spare {};
+
+using Snapshot = std::vector<std::tuple<sim::id_t, int, int> >;
+
+static void expect(const bool condition, const char* what) {
+    if (condition) return;
+    std::cerr << "Failed: " << what << '\n';
+    std::exit(EXIT_FAILURE);
+}
+
+// Each system creates an entity and marks the first entity with its own number.
+// B conflicts with A and C doesn't, so with workers C runs alongside A and B runs after both.
+template<int N>
+struct Recorder {
+    inline static sim::id_t first = sim::NO_ID;
+
+    void operator()(const sim::event::Cycle, ContextC auto ctx) const {
+        ctx.commands().create(Value{N});
+        ctx.commands().template emplace<Mark>(std::as_const(ctx).get_entity(first), N);
+    }
+};
+
+struct A : Recorder<1> {
+    using writes = sim::components<Value>;
+};
+
+struct B : Recorder<2> {
+    using writes = sim::components<Value>;
+};
+
+struct C : Recorder<3> {
+    using writes = sim::components<Spare>;
+};
+
+struct Collector {
+    inline static Snapshot snapshot;
+
+    void operator()(const sim::event::SimEnd, ContextC auto ctx) const {
+        snapshot.clear();
+        std::as_const(ctx).template view<Value>(sim::optional<Mark>)
+                .for_each([&](const auto& entity, const Value& value, const Mark* mark) {
+                    snapshot.emplace_back(entity.id(), value.v, mark ? mark->v : 0);
+                });
+    }
+};
+
+static Snapshot run(const size_t threads) {
+    auto simulation = sim::Simulation<>().with_systems<A, B, C, Collector>();
+    simulation.set_threads(threads);
+    auto first = simulation.create();
+    first.emplace<Value>(0);
+    Recorder<1>::first = Recorder<2>::first = Recorder<3>::first = first.id();
+    simulation.run(3);
+    return Collector::snapshot;
+}
+
+// The commands recorded by the systems must be applied in the same order whatever the number of threads
+static void outcome_does_not_depend_on_threads() {
+    const Snapshot serial = run(0);
+    expect(serial.size() == 10, "every system created an entity every cycle");
+    for (const size_t threads: {1, 3, 8})
+        for (int i = 0; i < 10; ++i)
+            expect(run(threads) == serial, "entities and components match the run without workers");
+}
+
+int main() {
+    outcome_does_not_depend_on_threads();
+    std::cout << "DispatcherTest passed\n";
+}
@@ -0,0 +1,102 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include "sim/Registry.h"
+#include "sim/View.h"
+
+struct Position {
+    int x, y;
+};
+
+struct Velocity {
+    int dx, dy;
+};
+
+template<>
+struct sim::track_changes<Position> : std::true_type {};
+
+template<>
+struct sim::track_changes<Velocity> : std::true_type {};
+
+static void expect(const bool condition, const char* what) {
+    if (condition) return;
+    std::cerr << "Failed: " << what << '\n';
+    std::exit(EXIT_FAILURE);
+}
+
+template<typename F>
+static bool throws_out_of_range(F&& f) {
+    try {
+        f();
+    } catch (const std::out_of_range&) {
+        return true;
+    }
+    return false;
+}
+
+// Adding components through a handle of a removed entity must not leak into the entity recycling its index
+static void stale_handle_is_rejected() {
+    sim::Registry registry;
+    auto old = registry.create();
+    registry.remove(old);
+
+    expect(throws_out_of_range([&] { old.emplace<Position>(1, 2); }), "emplace on a removed entity throws");
+    expect(throws_out_of_range([&] { registry.push_back(old, Position{1, 2}); }), "push_back on a removed entity throws");
+    const sim::id_t ids[]{old.id()};
+    expect(throws_out_of_range([&] { registry.emplace_many<Position>(ids, 1, 2); }),
+           "emplace_many on a removed entity throws");
+
+    auto recycled = registry.create();
+    expect(sim::to_index(recycled.id()) == sim::to_index(old.id()), "the index is recycled");
+    expect(!recycled.has<Position>(), "the recycled entity has no component");
+    expect(throws_out_of_range([&] { (void) registry.get<Position>(recycled.id()); }),
+           "the recycled entity has no component to get");
+    expect(registry.get_storage<Position>().size() == 0, "no component was stored under the removed ID");
+
+    recycled.emplace<Position>(3, 4);
+    expect(recycled.has<Position>() && registry.get<Position>(recycled.id()).x == 3, "the recycled entity gets its own");
+}
+
+// A mutable view only marks the components it requests mutably as changed
+static void const_components_are_not_marked() {
+    sim::Registry registry;
+    for (int i = 0; i < 4; ++i)
+        registry.create().emplace<Position>(i, i).emplace<Velocity>(1, 1);
+    registry.advance_tick();
+    registry.advance_tick(); // Past the additions
+
+    registry.view<Position, const Velocity>().for_each([](Position& p, const Velocity& v) {
+        p.x += v.dx;
+        p.y += v.dy;
+    });
+    const auto count = [&]<typename C>(std::type_identity<C>) {
+        return std::as_const(registry).view<C>(sim::changed<C>).collect().size();
+    };
+    expect(count(std::type_identity<Position>{}) == 4, "the written components are marked");
+    expect(count(std::type_identity<Velocity>{}) == 0, "the components requested as const are not marked");
+}
+
+// Adding a component an entity already has replaces it, rather than storing a second one
+static void emplace_replaces_existing_component() {
+    sim::Registry registry;
+    auto entity = registry.create();
+    entity.emplace<Position>(1, 2);
+    entity.emplace<Position>(3, 4);
+    registry.push_back(entity, Position{5, 6});
+
+    expect(registry.get_storage<Position>().size() == 1, "a single component is stored");
+    int visited = 0;
+    std::as_const(registry).view<Position>().for_each([&](const Position& p) {
+        ++visited;
+        expect(p.x == 5 && p.y == 6, "the last value is kept");
+    });
+    expect(visited == 1, "the entity is visited once");
+}
+
+int main() {
+    stale_handle_is_rejected();
+    const_components_are_not_marked();
+    emplace_replaces_existing_component();
+    std::cout << "RegistryTest passed\n";
+}